@@ -0,0 +1,102 @@
+#include "Simulation.h"
+#include "BatchIO.h"
+#include "Journal.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+// Action.cpp refers to the global backup defined by the simulation's main.
+Simulation* backup = nullptr;
+
+/*
+Measures the write-ahead journal and the recovery path.
+
+usage: replay_bench [num_commands] [num_synced_commands]
+
+1. Journals num_commands commands with group commit, then num_synced_commands commands committing
+   after every command, to show what grouping the fdatasync calls saves.
+2. Replays the grouped journal onto a fresh simulation, as `--recover` does, and reports the replayed
+   commands per second.
+*/
+
+// A handful of settlements, one facility per category and a few plans
+static void writeConfig(const string &path) {
+    ofstream config(path);
+    for (int i = 0; i < 8; i++) {
+        config << "settlement S" << i << " " << (i % 3) << "\n";
+    }
+    config << "facility Hospital 0 5 5 3 2\n"
+           << "facility Factory 1 5 2 5 1\n"
+           << "facility SolarFarm 2 4 2 2 4\n";
+    const char *policies[] = {"nve", "bal", "eco", "env"};
+    for (int i = 0; i < 16; i++) {
+        config << "plan S" << (i % 8) << " " << policies[i % 4] << "\n";
+    }
+}
+
+// A command mix close to an interactive session: mostly steps and status queries. The number of plans
+// stays fixed, so every step costs the same.
+static string makeCommand(int i) {
+    const char *policies[] = {"nve", "bal", "eco", "env"};
+    switch (i % 8) {
+        case 0: return "backup";
+        case 1: return "settlement T" + to_string(i) + " " + to_string(i % 3);
+        case 2: return "changePolicy " + to_string(i % 16) + " " + policies[(i / 8) % 4];
+        case 3: return "planStatus " + to_string(i % 16);
+        default: return "step 1";
+    }
+}
+
+// Journals numCommands commands and returns the elapsed seconds
+static double journalCommands(const string &path, int numCommands, bool commitEach) {
+    Journal journal(path, 0);
+    if (!journal.isOpen()) {
+        cout << "cannot open " << path << endl;
+        exit(1);
+    }
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < numCommands; i++) {
+        journal.append(makeCommand(i));
+        if (commitEach) {
+            journal.commit();
+        }
+    }
+    journal.commit();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int numCommands = argc > 1 ? atoi(argv[1]) : 1000000;
+    int numSynced = argc > 2 ? atoi(argv[2]) : 2000;
+    if (numCommands < 1 || numSynced < 1) {
+        cout << "usage: replay_bench [num_commands] [num_synced_commands]" << endl;
+        return 1;
+    }
+
+    const string configPath = "bin/replay_bench_config.txt";
+    const string journalPath = "bin/replay_bench_journal.txt";
+    writeConfig(configPath);
+
+    printf("%-22s %10s %12s %14s\n", "phase", "commands", "seconds", "commands/s");
+    double seconds = journalCommands(journalPath, numSynced, true);
+    printf("%-22s %10d %12.4f %14.0f\n", "journal, sync each", numSynced, seconds, numSynced / seconds);
+    seconds = journalCommands(journalPath, numCommands, false);
+    printf("%-22s %10d %12.4f %14.0f\n", "journal, group commit", numCommands, seconds, numCommands / seconds);
+
+    Simulation simulation(configPath);
+    LineReader journal(open(journalPath.c_str(), O_RDONLY), true);
+    size_t validBytes = 0;
+    auto start = chrono::steady_clock::now();
+    size_t replayed = simulation.replay(journal, validBytes);
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("%-22s %10zu %12.4f %14.0f\n", "replay", replayed, seconds, replayed / seconds);
+
+    remove(configPath.c_str());
+    remove(journalPath.c_str());
+    return replayed == static_cast<size_t>(numCommands) ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include "Simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// Action.cpp refers to the global backup defined by the simulation's main.
+Simulation* backup = nullptr;
+
+/*
+Measures how Simulation::step scales with the number of worker threads.
+
+usage: step_bench [num_plans] [num_steps] [max_threads]
+
+For every thread count from 1 to max_threads the same synthetic scenario is loaded, stepped
+num_steps times and timed. The final scores of every run are compared against the serial run,
+so the benchmark doubles as a check that the parallel path is deterministic.
+Every thread count is measured twice: once calling step() num_steps times (tick by tick) and once
+with a single step(num_steps) call (event-driven fast-forward).
+*/
+
+// Final scores of every plan, 3 per plan
+static vector<long long> collectScores(Simulation &simulation, int numPlans) {
+    vector<long long> scores;
+    for (int id = 0; id < numPlans; id++) {
+        Plan &plan = simulation.getPlan(id);
+        scores.push_back(plan.getlifeQualityScore());
+        scores.push_back(plan.getEconomyScore());
+        scores.push_back(plan.getEnvironmentScore());
+    }
+    return scores;
+}
+
+// Writes a config with a mix of settlement types and all four policies
+static void writeConfig(const string &path, int numPlans) {
+    ofstream config(path);
+    int numSettlements = numPlans / 4 + 1;
+    for (int i = 0; i < numSettlements; i++) {
+        config << "settlement S" << i << " " << (i % 3) << "\n";
+    }
+    config << "facility Hospital 0 5 5 3 2\n"
+           << "facility School 0 4 4 2 2\n"
+           << "facility Park 0 3 3 1 3\n"
+           << "facility Factory 1 5 2 5 1\n"
+           << "facility Market 1 4 3 3 2\n"
+           << "facility Bank 1 4 2 5 0\n"
+           << "facility RecyclingPlant 2 5 3 1 5\n"
+           << "facility SolarFarm 2 4 2 2 4\n"
+           << "facility WildlifeReserve 2 4 2 1 4\n";
+    const char *policies[] = {"nve", "bal", "eco", "env"};
+    for (int i = 0; i < numPlans; i++) {
+        config << "plan S" << (i % numSettlements) << " " << policies[i % 4] << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    int numPlans = argc > 1 ? atoi(argv[1]) : 200000;
+    int numSteps = argc > 2 ? atoi(argv[2]) : 100;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : static_cast<int>(thread::hardware_concurrency());
+    if (numPlans < 1 || numSteps < 1) {
+        cout << "usage: step_bench [num_plans] [num_steps] [max_threads]" << endl;
+        return 1;
+    }
+    if (maxThreads < 1) {
+        maxThreads = 1;
+    }
+
+    const string configPath = "bin/step_bench_config.txt";
+    writeConfig(configPath, numPlans);
+
+    vector<long long> reference; // Serial scores, 3 per plan
+    double serialSeconds = 0;
+
+    printf("plans=%d steps=%d\n", numPlans, numSteps);
+    printf("%8s %14s %12s %12s %10s %s\n", "threads", "mode", "seconds", "plan-steps/s", "speedup", "scores");
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        for (int fastForward = 0; fastForward <= 1; fastForward++) {
+            Simulation simulation(configPath);
+            simulation.setNumThreads(threads);
+
+            auto start = chrono::steady_clock::now();
+            if (fastForward) {
+                simulation.step(numSteps);
+            } else {
+                for (int i = 0; i < numSteps; i++) {
+                    simulation.step();
+                }
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            vector<long long> scores = collectScores(simulation, numPlans);
+            if (threads == 1 && !fastForward) {
+                reference = scores;
+                serialSeconds = seconds;
+            }
+
+            printf("%8d %14s %12.4f %12.0f %10.2f %s\n", threads, fastForward ? "fast-forward" : "tick-by-tick",
+                   seconds, static_cast<double>(numPlans) * numSteps / seconds, serialSeconds / seconds,
+                   scores == reference ? "identical" : "MISMATCH");
+            if (scores != reference) {
+                return 1;
+            }
+        }
+    }
+
+    remove(configPath.c_str());
+    return 0;
+}
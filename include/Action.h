@@ -2,13 +2,10 @@
 #include <string>
 #include <vector>
 #include "Simulation.h"
+#include "ActionLog.h"
 enum class SettlementType;
 enum class FacilityCategory;
 
-enum class ActionStatus{
-    COMPLETED, ERROR
-};
-
 class BaseAction{
     public:
         BaseAction();
@@ -16,12 +13,16 @@ class BaseAction{
         virtual void act(Simulation& simulation)=0;
         virtual const string toString() const=0;
         virtual BaseAction* clone() const = 0;
+        // Logs the action as a record of the simulation's actions log
+        virtual void appendTo(ActionLog &log) const = 0;
         virtual ~BaseAction() = default;
 
     protected:
         void complete();
         void error(string errorMsg);
         const string &getErrorMsg() const;
+        // A record of the given kind holding the status shared by all actions, the rest zeroed
+        LogRecord makeRecord(ActionLog &log, ActionKind kind) const;
 
     private:
         string errorMsg;
@@ -35,6 +36,7 @@ class SimulateStep : public BaseAction {
         void act(Simulation &simulation) override;
         const string toString() const override;
         SimulateStep *clone() const override;
+        void appendTo(ActionLog &log) const override;
     private:
         const int numOfSteps;
 };
@@ -45,6 +47,7 @@ class AddPlan : public BaseAction {
         void act(Simulation &simulation) override;
         const string toString() const override;
         AddPlan *clone() const override;
+        void appendTo(ActionLog &log) const override;
 
         // Helper function to make sure policy is valid
         bool isValidPolicy(const string &policyName);
@@ -60,6 +63,7 @@ class AddSettlement : public BaseAction {
         AddSettlement(const string &settlementName,SettlementType settlementType);
         void act(Simulation &simulation) override;
         AddSettlement *clone() const override;
+        void appendTo(ActionLog &log) const override;
         const string toString() const override;
     private:
         const string settlementName;
@@ -73,6 +77,7 @@ class AddFacility : public BaseAction {
         AddFacility(const string &facilityName, const FacilityCategory facilityCategory, const int price, const int lifeQualityScore, const int economyScore, const int environmentScore);
         void act(Simulation &simulation) override;
         AddFacility *clone() const override;
+        void appendTo(ActionLog &log) const override;
         const string toString() const override;
     private:
         const string facilityName;
@@ -89,6 +94,7 @@ class PrintPlanStatus: public BaseAction {
         PrintPlanStatus(int planId);
         void act(Simulation &simulation) override;
         PrintPlanStatus *clone() const override;
+        void appendTo(ActionLog &log) const override;
         const string toString() const override;
     private:
         const int planId;
@@ -100,6 +106,7 @@ class ChangePlanPolicy : public BaseAction {
         ChangePlanPolicy(const int planId, const string &newPolicy);
         void act(Simulation &simulation) override;
         ChangePlanPolicy *clone() const override;
+        void appendTo(ActionLog &log) const override;
         const string toString() const override;
     private:
         const int planId;
@@ -112,6 +119,7 @@ class PrintActionsLog : public BaseAction {
         PrintActionsLog();
         void act(Simulation &simulation) override;
         PrintActionsLog *clone() const override;
+        void appendTo(ActionLog &log) const override;
         const string toString() const override;
     private:
 };
@@ -121,6 +129,7 @@ class Close : public BaseAction {
         Close();
         void act(Simulation &simulation) override;
         Close *clone() const override;
+        void appendTo(ActionLog &log) const override;
         const string toString() const override;
     private:
 };
@@ -130,6 +139,7 @@ class BackupSimulation : public BaseAction {
         BackupSimulation();
         void act(Simulation &simulation) override;
         BackupSimulation *clone() const override;
+        void appendTo(ActionLog &log) const override;
         const string toString() const override;
     private:
 };
@@ -140,6 +150,31 @@ class RestoreSimulation : public BaseAction {
         RestoreSimulation();
         void act(Simulation &simulation) override;
         RestoreSimulation *clone() const override;
+        void appendTo(ActionLog &log) const override;
+        const string toString() const override;
+    private:
+};
+
+// Writes the simulation (and the backup, if any) to a binary snapshot file
+class SaveSnapshot : public BaseAction {
+    public:
+        SaveSnapshot(const string &path);
+        void act(Simulation &simulation) override;
+        SaveSnapshot *clone() const override;
+        void appendTo(ActionLog &log) const override;
+        const string toString() const override;
+    private:
+        const string path;
+};
+
+// Replaces the simulation (and the backup) with the content of a snapshot file
+class LoadSnapshot : public BaseAction {
+    public:
+        LoadSnapshot(const string &path);
+        void act(Simulation &simulation) override;
+        LoadSnapshot *clone() const override;
+        void appendTo(ActionLog &log) const override;
         const string toString() const override;
     private:
+        const string path;
 };
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CowVector.h"
+#include "Snapshot.h"
+using std::string;
+using std::vector;
+
+enum class ActionStatus{
+    COMPLETED, ERROR
+};
+
+// Kind of a logged action. Values are part of the snapshot format, only append.
+enum class ActionKind : uint8_t {
+    STEP,
+    ADD_PLAN,
+    ADD_SETTLEMENT,
+    ADD_FACILITY,
+    PRINT_PLAN_STATUS,
+    CHANGE_POLICY,
+    PRINT_ACTIONS_LOG,
+    CLOSE,
+    BACKUP,
+    RESTORE,
+    SAVE,
+    LOAD,
+};
+
+// One entry of the actions log: a plain record whose strings are ids into the log's string table.
+// A record stands for `repeat` consecutive identical actions.
+struct LogRecord {
+    ActionKind kind;
+    ActionStatus status;
+    uint8_t type;       // Settlement type or facility category
+    uint32_t repeat;
+    uint32_t text[2];   // Settlement / facility name or snapshot path, then the selection policy
+    uint32_t error;     // Error message, the empty string when completed
+    int32_t values[4];  // Step count or plan ID, or the price and the 3 impacts of a facility
+};
+
+/*
+The actions log of a simulation, stored as compact records instead of one heap object per action:
+
+- Strings (names, policies, paths, error messages) are interned once in a string table.
+- Consecutive identical actions, such as a long run of `step 1`, fold into a single record.
+- Records are kept in a CowVector, so copies of the log (backups) share them and copying is O(1).
+  The string table only grows and is shared by all copies, like the name indices of Simulation.
+*/
+class ActionLog {
+    public:
+        ActionLog();
+
+        // Number of logged actions, each folded repetition counted
+        size_t size() const;
+        // Number of records actually stored
+        size_t recordCount() const;
+
+        // Id of a string in the table, adding it if needed
+        uint32_t intern(const string &text);
+
+        // Logs an action. If it is identical to the last one, only the repeat count of the last record grows.
+        void append(const LogRecord &record);
+
+        // The text of a logged action, the same as the toString() of the action it was made from
+        string toString(const LogRecord &record) const;
+        // Writes the text of every logged action on its own line
+        void print(std::ostream &out) const;
+
+        // Forgets every action and starts a new string table
+        void clear();
+
+        // Writes the strings the records use, then the records. Read back by the snapshot constructor.
+        void save(SnapshotWriter &out) const;
+        explicit ActionLog(SnapshotReader &in);
+
+    private:
+        struct StringTable {
+            StringTable();
+
+            vector<string> strings;
+            std::unordered_map<string, uint32_t> ids;
+        };
+
+        CowVector<LogRecord> records;
+        size_t actionCount;
+        std::shared_ptr<StringTable> table;
+};
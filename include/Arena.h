@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+using std::vector;
+
+// A bump allocator owned by a Simulation.
+// Objects are carved out of large blocks, so creating one is a pointer bump, and they are never freed one by one:
+// reset() runs the pending destructors and releases every block at once.
+class Arena {
+    public:
+        explicit Arena(size_t blockSize = 64 * 1024);
+
+        // Objects live at fixed addresses inside the blocks, so an arena can be moved but not copied
+        Arena(const Arena &other) = delete;
+        Arena &operator=(const Arena &other) = delete;
+        Arena(Arena &&other);
+        Arena &operator=(Arena &&other);
+        ~Arena();
+
+        // Constructs a T inside the arena. The object stays valid until reset() or the arena's destruction.
+        template <typename T, typename... Args>
+        T *create(Args&&... args);
+
+        // Destroys every object (in reverse creation order) and releases all blocks
+        void reset();
+
+        // Allocation counters
+        size_t getLiveObjects() const;      // Objects created since the last reset
+        size_t getLiveBytes() const;        // Bytes handed out since the last reset
+        size_t getReservedBytes() const;    // Bytes held in blocks
+        size_t getBlockCount() const;
+        size_t getTotalAllocations() const; // Objects created over the arena's whole lifetime
+
+    private:
+        // Returns size bytes aligned to alignment, opening a new block when the current one is full
+        void *allocate(size_t size, size_t alignment);
+        void releaseBlocks();
+
+        // Type-erased destructor call, only registered for types that need one
+        struct Finalizer {
+            void (*destroy)(void *object);
+            void *object;
+        };
+
+        template <typename T>
+        static void destroy(void *object);
+
+        size_t blockSize;
+        vector<char*> blocks;
+        char *cursor; // Next free byte in the current block
+        char *limit;  // End of the current block
+        vector<Finalizer> finalizers;
+        size_t liveObjects;
+        size_t liveBytes;
+        size_t reservedBytes;
+        size_t totalAllocations;
+};
+
+template <typename T, typename... Args>
+T *Arena::create(Args&&... args) {
+    void *memory = allocate(sizeof(T), alignof(T));
+    T *object = new (memory) T(std::forward<Args>(args)...);
+
+    // Trivially destructible objects are simply dropped with their block
+    if (!std::is_trivially_destructible<T>::value) {
+        finalizers.push_back(Finalizer{&Arena::destroy<T>, object});
+    }
+    liveObjects++;
+    totalAllocations++;
+    return object;
+}
+
+template <typename T>
+void Arena::destroy(void *object) {
+    static_cast<T*>(object)->~T();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+// Reads lines from a file descriptor in large blocks, one read() per block instead of per character.
+// Lines are split on '\n' only, like std::getline.
+class LineReader {
+    public:
+        static const size_t BLOCK_SIZE = 1 << 20;
+
+        // Reads from fd, which the reader closes if it owns it
+        LineReader(int fd, bool ownsFd);
+
+        // The reader owns the descriptor and its buffer, so it can be neither copied nor moved
+        LineReader(const LineReader &other) = delete;
+        LineReader &operator=(const LineReader &other) = delete;
+        ~LineReader();
+
+        // Stores the next line without its '\n'. Returns false at the end of the input.
+        bool nextLine(string &line);
+
+        // Whether the line returned last ended with a '\n', which only the last line of the input may lack
+        bool lastLineComplete() const;
+
+    private:
+        // Moves the unread bytes to the front of the buffer and reads the next block. Returns false at the end.
+        bool fill();
+
+        int fd;
+        bool ownsFd;
+        vector<char> buffer;
+        size_t begin; // Unread bytes are buffer[begin, end)
+        size_t end;
+        bool finished; // read() reported the end of the input or an error
+        bool complete;
+};
+
+// A stream buffer that collects everything written to it and writes it to a file descriptor in large blocks.
+// Flushing the stream (std::endl, std::flush) does not write anything, only a full buffer, flush() and
+// the destructor do. Installed in std::cout and std::cerr by the batch mode, see Simulation::startBatch.
+class BufferedOutput : public std::streambuf {
+    public:
+        static const size_t BUFFER_SIZE = 1 << 20;
+
+        explicit BufferedOutput(int fd);
+
+        BufferedOutput(const BufferedOutput &other) = delete;
+        BufferedOutput &operator=(const BufferedOutput &other) = delete;
+        ~BufferedOutput();
+
+        // Writes out everything buffered so far
+        void flush();
+
+        // Flushes the stream for real: flush() if it writes through a BufferedOutput, std::flush otherwise
+        static void flush(std::ostream &stream);
+
+    protected:
+        int_type overflow(int_type ch) override;
+        std::streamsize xsputn(const char *data, std::streamsize count) override;
+        int sync() override;
+
+    private:
+        void writeAll(const char *data, size_t count);
+
+        int fd;
+        vector<char> buffer;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "ThreadPool.h"
+using std::string;
+using std::vector;
+
+// A piece of the mapped config file. Tokens point into the mapping, so they are only valid while the loader lives.
+struct ConfigToken {
+    const char *data;
+    uint32_t length;
+
+    string str() const;
+    bool equals(const char *text) const;
+};
+
+enum class ConfigEntryType {
+    SETTLEMENT,
+    FACILITY,
+    PLAN,
+    THREADS,
+};
+
+// One parsed config line
+struct ConfigEntry {
+    ConfigEntryType type;
+    uint32_t line;      // Line number within its chunk, from 0
+    ConfigToken name;   // Settlement or facility name, or the settlement of a plan
+    ConfigToken policy; // Selection policy of a plan
+    int values[5];      // Settlement: type. Facility: category, price and the 3 impacts. Threads: thread count.
+};
+
+// Entries of a range of whole lines, in file order
+struct ConfigChunk {
+    ConfigChunk();
+
+    vector<ConfigEntry> entries;
+    size_t firstLine;    // Line number (from 1) of the chunk's first line
+    size_t lineCount;
+    bool failed;         // Parsing stopped at a malformed line, entries holds the lines before it
+    size_t errorLine;    // Line number (from 1) of the malformed line
+    string errorMessage;
+};
+
+/*
+Parses a config file without copying it: the file is memory-mapped, lines are split into tokens that point
+into the mapping and numbers are parsed in place. Large files are cut into chunks of whole lines that are
+parsed on worker threads, each chunk keeping its entries in file order.
+
+Only the syntax is checked here (entry types, argument counts, numbers and enum ranges), the simulation applies
+the entries chunk by chunk and checks the rest (such as the settlement of a plan), so the first error reported
+is always the one on the earliest line.
+*/
+class ConfigLoader {
+    public:
+        // Files smaller than this are parsed on the calling thread
+        static const size_t PARALLEL_THRESHOLD = 4 * 1024 * 1024;
+
+        // Maps the file. Throws std::runtime_error if it cannot be opened.
+        explicit ConfigLoader(const string &path);
+
+        size_t getSize() const;
+
+        // Parses the whole file. With a pool the file is cut into one chunk per thread.
+        void parse(ThreadPool *pool);
+
+        const vector<ConfigChunk> &getChunks() const;
+
+    private:
+        void parseChunk(const char *begin, const char *end, ConfigChunk &chunk) const;
+
+        MappedFile file;
+        vector<ConfigChunk> chunks;
+};
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+using std::vector;
+
+// A vector whose copies share their elements until one of them writes (copy-on-write).
+// Elements live in fixed-size chunks and the list of chunks is shared as well, so copying a CowVector is O(1).
+// The first write through a copy duplicates the list of chunks and the chunk being written,
+// so a copy only costs memory for the chunks modified after it was taken.
+// Copies can be read from any thread. Concurrent writes to one CowVector are only safe after makeUnique().
+template <typename T>
+class CowVector {
+    public:
+        static const size_t CHUNK_SIZE = 256;
+
+        CowVector();
+
+        size_t size() const;
+        bool empty() const;
+
+        // Read access never copies
+        const T &operator[](size_t index) const;
+
+        // Write access: first copies the chunk holding the element if another CowVector shares it
+        T &mutate(size_t index);
+
+        void push_back(const T &value);
+        void push_back(T &&value);
+
+        // Drops this vector's references. Elements stay alive as long as another copy shares them.
+        void clear();
+
+        // Copies every shared chunk, so that mutate() copies nothing until the vector is copied again
+        // and distinct elements can be mutated from different threads
+        void makeUnique();
+
+    private:
+        typedef vector<T> Chunk;
+        typedef vector<std::shared_ptr<Chunk>> Directory;
+
+        Directory &ownDirectory();
+        Chunk &ownChunk(size_t chunkIndex);
+        // Writable last chunk with room for one more element
+        Chunk &tailChunk();
+
+        std::shared_ptr<Directory> directory; // Null while empty
+};
+
+template <typename T>
+const size_t CowVector<T>::CHUNK_SIZE;
+
+template <typename T>
+CowVector<T>::CowVector() : directory() {}
+
+template <typename T>
+size_t CowVector<T>::size() const {
+    // Every chunk but the last one is full
+    if (!directory || directory->empty()) {
+        return 0;
+    }
+    return (directory->size() - 1) * CHUNK_SIZE + directory->back()->size();
+}
+
+template <typename T>
+bool CowVector<T>::empty() const {
+    return size() == 0;
+}
+
+template <typename T>
+const T &CowVector<T>::operator[](size_t index) const {
+    return (*(*directory)[index / CHUNK_SIZE])[index % CHUNK_SIZE];
+}
+
+template <typename T>
+T &CowVector<T>::mutate(size_t index) {
+    return ownChunk(index / CHUNK_SIZE)[index % CHUNK_SIZE];
+}
+
+template <typename T>
+void CowVector<T>::push_back(const T &value) {
+    tailChunk().push_back(value);
+}
+
+template <typename T>
+void CowVector<T>::push_back(T &&value) {
+    tailChunk().push_back(std::move(value));
+}
+
+template <typename T>
+void CowVector<T>::clear() {
+    directory.reset();
+}
+
+template <typename T>
+void CowVector<T>::makeUnique() {
+    if (!directory) {
+        return;
+    }
+    for (size_t i = 0; i < directory->size(); i++) {
+        ownChunk(i);
+    }
+}
+
+template <typename T>
+typename CowVector<T>::Directory &CowVector<T>::ownDirectory() {
+    if (!directory) {
+        directory = std::make_shared<Directory>();
+    } else if (directory.use_count() > 1) {
+        // Copies the chunk pointers only, the chunks themselves stay shared
+        directory = std::make_shared<Directory>(*directory);
+    }
+    return *directory;
+}
+
+template <typename T>
+typename CowVector<T>::Chunk &CowVector<T>::tailChunk() {
+    Directory &chunks = ownDirectory();
+    if (chunks.empty() || chunks.back()->size() == CHUNK_SIZE) {
+        // Chunks reserve their full size up front, so elements never move while a chunk fills up
+        chunks.push_back(std::make_shared<Chunk>());
+        chunks.back()->reserve(CHUNK_SIZE);
+    }
+    return ownChunk(chunks.size() - 1);
+}
+
+template <typename T>
+typename CowVector<T>::Chunk &CowVector<T>::ownChunk(size_t chunkIndex) {
+    Directory &chunks = ownDirectory();
+    std::shared_ptr<Chunk> &chunk = chunks[chunkIndex];
+    if (chunk.use_count() > 1) {
+        std::shared_ptr<Chunk> copy = std::make_shared<Chunk>();
+        copy->reserve(CHUNK_SIZE);
+        for (const T &element : *chunk) {
+            copy->push_back(element);
+        }
+        chunk = copy;
+    }
+    return *chunk;
+}
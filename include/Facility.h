@@ -48,6 +48,8 @@ class Facility: public FacilityType {
         const string &getSettlementName() const;
         const int getTimeLeft() const;
         FacilityStatus step();
+        // Same as calling step() `ticks` times in a row
+        FacilityStatus advance(int ticks);
         void setStatus(FacilityStatus status);
         const FacilityStatus& getStatus() const;
         const string toString() const;
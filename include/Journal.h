@@ -0,0 +1,53 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+using std::string;
+
+/*
+Append-only, write-ahead journal of the commands accepted by the simulation, one command line per line.
+Replaying the journal onto the config (or snapshot) the simulation started from rebuilds its state,
+see Simulation::replay and `--recover`.
+
+Commands are collected in memory and committed in groups, one write() and one fdatasync() per group:
+a group is committed once it holds GROUP_COMMANDS commands or GROUP_BYTES bytes, once its oldest command
+is GROUP_INTERVAL old, and whenever the simulation waits for input, is flushed or ends. A crash loses
+at most the last uncommitted group. A line cut short by a crash is ignored and dropped by the recovery.
+*/
+class Journal {
+    public:
+        static const size_t GROUP_COMMANDS = 4096;
+        static const size_t GROUP_BYTES = 1 << 20;
+        static const std::chrono::milliseconds GROUP_INTERVAL;
+
+        // Opens the journal for appending, keeping only its first keepBytes bytes (0 starts a new journal).
+        // Like std::ofstream, a file that cannot be opened leaves the object closed instead of throwing.
+        Journal(const string &path, size_t keepBytes);
+
+        // The journal owns its descriptor, so it can be neither copied nor moved
+        Journal(const Journal &other) = delete;
+        Journal &operator=(const Journal &other) = delete;
+        // Commits the pending commands
+        ~Journal();
+
+        bool isOpen() const;
+
+        // Adds one command line, committing the group if it is due
+        void append(const string &command);
+
+        // Writes the pending commands and waits until they are on disk. Throws std::runtime_error on failure.
+        void commit();
+
+        // Counters, for reporting
+        size_t getCommandCount() const;
+        size_t getCommitCount() const;
+
+    private:
+        string path;
+        int fd;
+        string pending; // Command lines not written yet, each ending with '\n'
+        size_t pendingCommands;
+        std::chrono::steady_clock::time_point oldestPending;
+        size_t commandCount;
+        size_t commitCount;
+};
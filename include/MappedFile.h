@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <string>
+using std::string;
+
+// A whole file mapped read-only into memory.
+// Like std::ifstream, a file that cannot be opened leaves the object closed instead of throwing.
+class MappedFile {
+    public:
+        explicit MappedFile(const string &path);
+
+        // The object owns the mapping, so it can be neither copied nor moved
+        MappedFile(const MappedFile &other) = delete;
+        MappedFile &operator=(const MappedFile &other) = delete;
+        ~MappedFile();
+
+        bool isOpen() const;
+        // Contents of the file, null for an empty file
+        const char *data() const;
+        size_t size() const;
+
+    private:
+        bool opened;
+        const char *contents;
+        size_t length;
+};
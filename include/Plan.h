@@ -12,7 +12,9 @@ enum class PlanStatus {
 
 class Plan {
     public:
-        Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const vector<FacilityType> &facilityOptions);
+        // The facility options are not stored in the plan: the simulation passes its catalog to the methods that need it,
+        // so copies of a simulation can share plans while each keeps its own catalog.
+        Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy);
         
         //Rule of 5
         Plan(const Plan &other); // Copy constructor
@@ -33,26 +35,53 @@ class Plan {
         //Getter for selection policy
         const SelectionPolicy* getSelectionPolicy() const;
 
-        //Getter for underConstruction
-        const vector<Facility*>& getFacilitiesUnderConstruction() const;
+        //Getter for underConstruction. The facilities are built from the packed store on demand.
+        vector<Facility> getFacilitiesUnderConstruction(const vector<FacilityType> &facilityOptions) const;
         
         const int getlifeQualityScore() const;
         const int getEconomyScore() const;
         const int getEnvironmentScore() const;
         void setSelectionPolicy(SelectionPolicy *selectionPolicy);
-        void step();
-        void printStatus();
-        const vector<Facility*> &getFacilities() const;
-        void addFacility(Facility* facility);
-        const string toString() const;
+        void step(const vector<FacilityType> &facilityOptions);
+
+        // Number of steps until the next step that does more than count down construction times:
+        // 1 if the plan will select new facilities, otherwise the time left of the facility that finishes first.
+        int ticksUntilEvent() const;
+
+        // Counts down the facilities under construction by `ticks` steps.
+        // Only valid for ticks < ticksUntilEvent(), when the skipped steps select and complete nothing.
+        // Construction times are kept as due ticks on the plan's clock, so this is O(1).
+        void skip(int ticks);
+
+        void printStatus(const vector<FacilityType> &facilityOptions) const;
+        // Operational facilities, built from the packed store on demand
+        vector<Facility> getFacilities(const vector<FacilityType> &facilityOptions) const;
+        // Starts constructing a facility of the given type, which must be an entry of facilityOptions
+        void addFacility(const FacilityType &facilityType, const vector<FacilityType> &facilityOptions);
+        const string toString(const vector<FacilityType> &facilityOptions) const;
+
+        // Writes the plan's state to a snapshot. The settlement is written by the simulation, as a position.
+        void save(SnapshotWriter &out) const;
+        // Reads a plan written by save, checking its facilities against the catalog
+        static Plan load(SnapshotReader &in, const Settlement &settlement, const vector<FacilityType> &facilityOptions);
 
     private:
+        // Builds the Facility object for an entry of the packed store
+        Facility buildFacility(const vector<FacilityType> &facilityOptions, int typeId, int dueTick) const;
+
+        // Moves the facilities due on the current tick from construction to the operational list
+        void completeDueFacilities(const vector<FacilityType> &facilityOptions);
+
         int plan_id;
         const Settlement &settlement;
         SelectionPolicy *selectionPolicy; //What happens if we change this to a reference?
         PlanStatus status;
-        vector<Facility*> facilities;
-        vector<Facility*> underConstruction;
-        const vector<FacilityType> &facilityOptions;
         int life_quality_score, economy_score, environment_score;
+        int clock; // Number of steps this plan went through
+
+        // Facility store: packed columns of indices into facilityOptions instead of heap allocated Facility objects
+        vector<int> facilityTypes;     // Operational facilities, in the order they became operational
+        vector<int> constructionTypes; // Facilities under construction, in selection order
+        vector<int> constructionDue;   // Plan tick on which each facility under construction becomes operational
+        int nextDue;                   // Earliest entry of constructionDue, valid while it is not empty
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include "Facility.h"
+#include "Snapshot.h"
 using std::vector;
 
 
@@ -12,6 +13,8 @@ class SelectionPolicy {
 
         virtual const string toString() const = 0;
         virtual SelectionPolicy* clone() const = 0;   
+        // Writes the policy's name and selection state, read back by loadPolicy
+        virtual void save(SnapshotWriter &out) const = 0;
 
         //Destructor
         virtual ~SelectionPolicy() = default;
@@ -21,12 +24,17 @@ class SelectionPolicy {
 //Helper function to convert string to policy
 SelectionPolicy* createPolicy(const std::string &policyName);
 
+//Helper function to read a policy written by SelectionPolicy::save
+SelectionPolicy* loadPolicy(SnapshotReader &in);
+
 class NaiveSelection: public SelectionPolicy {
     public:
         NaiveSelection();
         const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
         const string toString() const override;
         NaiveSelection *clone() const override;
+        void save(SnapshotWriter &out) const override;
+        static NaiveSelection *load(SnapshotReader &in);
         ~NaiveSelection() override = default;
     private:
         int lastSelectedIndex;
@@ -38,6 +46,8 @@ class BalancedSelection: public SelectionPolicy {
         const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
         const string toString() const override;
         BalancedSelection *clone() const override;
+        void save(SnapshotWriter &out) const override;
+        static BalancedSelection *load(SnapshotReader &in);
         ~BalancedSelection() override = default;
 
         // Setter methods to update scores
@@ -62,6 +72,8 @@ class EconomySelection: public SelectionPolicy {
         const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
         const string toString() const override;
         EconomySelection *clone() const override;
+        void save(SnapshotWriter &out) const override;
+        static EconomySelection *load(SnapshotReader &in);
         ~EconomySelection() override = default;
     private:
         int lastSelectedIndex;
@@ -74,6 +86,8 @@ class SustainabilitySelection: public SelectionPolicy {
         const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
         const string toString() const override;
         SustainabilitySelection *clone() const override;
+        void save(SnapshotWriter &out) const override;
+        static SustainabilitySelection *load(SnapshotReader &in);
         ~SustainabilitySelection() override = default;
     private:
         int lastSelectedIndex;
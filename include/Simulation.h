@@ -1,20 +1,32 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include "Facility.h"
 #include "Plan.h"
 #include "Settlement.h"
+#include "ThreadPool.h"
+#include "Arena.h"
+#include "CowVector.h"
+#include "Snapshot.h"
+#include "ActionLog.h"
 using std::string;
 using std::vector;
 
 class BaseAction;
+class LineReader;
+class Journal;
 class SelectionPolicy;
 
 class Simulation {
     public:
-        Simulation(const string &configFilePath);
+        // Reads the config file. A positive numThreads overrides the file's thread count,
+        // and is also the number of threads used to parse a large file.
+        Simulation(const string &configFilePath, int numThreads = 0);
 
         //Rule of 5:
+        // Copies share the simulation state and copy it on write, so copying and copy-assigning are O(1)
         Simulation(const Simulation &other); // Copy constructor
         Simulation &operator=(const Simulation &other); // Copy assignment operator
         Simulation(Simulation &&other); // Move constructor
@@ -22,28 +34,106 @@ class Simulation {
         ~Simulation(); // Destructor 
         
         // Getter for actions log
-        const vector<BaseAction*>& getActionsLog() const;
+        const ActionLog& getActionsLog() const;
+
+        // Getter for the facility types plans choose from
+        const vector<FacilityType> &getFacilitiesOptions() const;
 
         // User interface
         void runCommandLoop();
 
         void start();
+        // Runs the commands read from input without prompting, writing all output through large buffers
+        // that are only written out when full, on a `flush` command and at the end. Reports the throughput.
+        void startBatch(LineReader &input);
+        // Runs the commands of a journal as fast as possible and without printing anything, to rebuild the state
+        // they led to. Returns the number of commands replayed. A last line without a '\n' was torn by a crash
+        // and is not replayed, validBytes is set to the length of the lines before it.
+        size_t replay(LineReader &journal, size_t &validBytes);
         void addPlan(const Settlement &settlement, SelectionPolicy *selectionPolicy);
-        void addAction(BaseAction *action);
-        bool addSettlement(Settlement *settlement);
+        // Logs the action as a compact record
+        void addAction(const BaseAction &action);
+        // Adds a copy of the settlement, allocated in the simulation's arena
+        bool addSettlement(const Settlement &settlement);
         bool addFacility(FacilityType facility);
         bool isSettlementExists(const string &settlementName);
         Settlement &getSettlement(const string &settlementName);
+        // The non-const overload gives this simulation its own copy of the plan if it is shared with a copy
         Plan &getPlan(const int planID);
+        const Plan &getPlan(const int planID) const;
         void step();
+        // Advances numOfSteps steps at once, jumping from event to event instead of sweeping every step.
+        // Ends in exactly the same state as calling step() numOfSteps times.
+        void step(int numOfSteps);
         void close();
         void open();
 
+        // Number of threads used by step(). 1 keeps the original serial loop.
+        void setNumThreads(int numThreads);
+        int getNumThreads() const;
+
+        // Journal the accepted commands are appended to, null to stop journaling. Not owned, and only used by
+        // this simulation: copies (backups) never journal, and assigning to a simulation keeps its journal.
+        void setJournal(Journal *journal);
+
+        // Allocator holding the settlements, exposes allocation counters
+        const Arena &getArena() const;
+
+        // Writes the simulation, followed by the backup if it is not null, to a binary snapshot file
+        void saveSnapshot(const string &path, const Simulation *backup) const;
+        // Reads a snapshot file written by saveSnapshot. The backup is set to a new Simulation if the file has one,
+        // otherwise to null. Throws std::runtime_error if the file cannot be read or is corrupt.
+        static Simulation loadSnapshot(const string &path, Simulation *&backup);
+
     private:
+        // Parses and runs one command line. Throws std::runtime_error for a malformed command.
+        void runCommand(const string &input);
+
+        // Reads one simulation image of a snapshot, see save
+        explicit Simulation(SnapshotReader &in);
+        // Writes the simulation as one length-prefixed image
+        void save(SnapshotWriter &out) const;
+
+        // Lazily creates (or resizes) the worker pool used by step()
+        ThreadPool &getThreadPool();
+
+        // Name lookups through the shared indices, see settlementIndex below
+        Settlement *findSettlement(const string &settlementName) const;
+        // Only considers the first count settlements
+        Settlement *findSettlement(const string &settlementName, size_t count) const;
+        bool isFacilityExists(const string &facilityName) const;
+
+        // Writable catalog, copied first if a copy of this simulation shares it
+        vector<FacilityType> &ownFacilitiesOptions();
+
+        // Starts over with an empty state that no copy shares
+        void resetState();
+
+        // Event-driven fast-forward of plans [begin, end) by numOfSteps steps
+        void fastForward(size_t begin, size_t end, int numOfSteps);
+
         bool isRunning;
         int planCounter; //For assigning unique plan IDs
-        vector<BaseAction*> actionsLog;
-        vector<Plan> plans;
-        vector<Settlement*> settlements;
-        vector<FacilityType> facilitiesOptions;
+
+        // The state below is shared with copies of the simulation (backups) and copied on write.
+        // Settlements never change once created, so copies share them outright.
+        // Plans and logged actions are copied a chunk at a time and the catalog as a whole, when one side modifies them.
+
+        // Owns every Settlement of this simulation and of its copies, declared first so it outlives the pointers
+        // below. Objects are only ever added to it, and it is released when the last copy using it is closed
+        // or destroyed.
+        std::shared_ptr<Arena> arena;
+        ActionLog actionsLog;
+        CowVector<Plan> plans; // Plan IDs are dense, so a plan's ID is also its position in this vector
+        CowVector<Settlement*> settlements;
+        std::shared_ptr<vector<FacilityType>> facilitiesOptions;
+
+        // Name -> position in settlements / facilitiesOptions. The indices only grow and are shared by all copies,
+        // each copy registering what it adds, so a copy never has to copy them. A position found here belongs
+        // to this simulation only if it is within its vector and holds the name looked for.
+        std::shared_ptr<std::unordered_multimap<string, size_t>> settlementIndex;
+        std::shared_ptr<std::unordered_multimap<string, size_t>> facilityIndex;
+        int numThreads;
+        ThreadPool *threadPool; // Owned, never copied: every Simulation spins up its own workers on demand
+        Journal *journal;
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+using std::string;
+using std::vector;
+
+/*
+Binary snapshot format, written by `save` and read by `load` / `--snapshot`:
+
+    header   magic "SPLSNAP\0", u32 version, u32 byte order mark, u32 flags (bit 0: a backup follows)
+    image    the simulation, see Simulation::save
+    image    the backup, only if flag bit 0 is set
+
+Every image is prefixed with its length in bytes (u64), strings with theirs (u32) and arrays with their
+element count (u32). Integers are stored in the byte order of the machine that wrote them, the byte order
+mark rejects snapshots written on a machine of the other byte order.
+*/
+
+// Serializes values into an in-memory buffer that is written to disk in one go
+class SnapshotWriter {
+    public:
+        SnapshotWriter();
+
+        void writeHeader(bool hasBackup);
+
+        void writeU8(uint8_t value);
+        void writeU32(uint32_t value);
+        void writeI32(int32_t value);
+        void writeString(const string &value);
+        // Element count followed by the elements
+        void writeInts(const vector<int> &values);
+
+        // A length-prefixed section: beginSection() reserves the length, endSection() fills it in
+        size_t beginSection();
+        void endSection(size_t section);
+
+        // Writes the buffer to path, replacing the file. Throws std::runtime_error on failure.
+        void saveTo(const string &path) const;
+
+    private:
+        void writeBytes(const void *data, size_t size);
+
+        vector<char> buffer;
+};
+
+// Reads values straight out of a memory-mapped snapshot file.
+// Every read is bounds-checked, a truncated or corrupt file throws std::runtime_error.
+class SnapshotReader {
+    public:
+        // Maps the file. Throws std::runtime_error if it cannot be opened.
+        explicit SnapshotReader(const string &path);
+
+        // The reader owns the mapping, so it can be neither copied nor moved
+        SnapshotReader(const SnapshotReader &other) = delete;
+        SnapshotReader &operator=(const SnapshotReader &other) = delete;
+
+        // Validates the header and returns whether a backup image follows the simulation
+        bool readHeader();
+
+        uint8_t readU8();
+        uint32_t readU32();
+        int32_t readI32();
+        string readString();
+        vector<int> readInts();
+
+        // Returns the end of the section, which endSection() checks was reached exactly
+        size_t beginSection();
+        void endSection(size_t sectionEnd);
+
+        // Checks that the whole file was consumed
+        void expectEnd() const;
+
+        // Throws the error used for every malformed snapshot
+        [[noreturn]] void corrupt(const string &reason) const;
+
+    private:
+        void readBytes(void *data, size_t size);
+
+        string path;
+        MappedFile file;
+        const char *data; // Contents of the mapped file, null for an empty file
+        size_t size;
+        size_t position;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+using std::vector;
+
+// A fixed-size pool of worker threads used to split per-plan work across cores.
+// The calling thread always takes part in the work, so a pool of size N owns N-1 threads.
+class ThreadPool {
+    public:
+        explicit ThreadPool(int numThreads);
+
+        // The pool owns running threads, so it can be neither copied nor moved.
+        ThreadPool(const ThreadPool &other) = delete;
+        ThreadPool &operator=(const ThreadPool &other) = delete;
+        ~ThreadPool();
+
+        // Number of threads (including the caller) that take part in parallelFor.
+        int size() const;
+
+        // Splits [0, count) into size() contiguous chunks and runs task(begin, end) on each chunk concurrently.
+        // Blocks until every chunk is done. If chunks throw, the exception of the lowest chunk is rethrown,
+        // so the reported error does not depend on thread scheduling.
+        void parallelFor(size_t count, const std::function<void(size_t, size_t)> &task);
+
+    private:
+        void workerLoop(size_t chunkIndex);
+        void runChunk(size_t chunkIndex);
+
+        vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wakeWorkers;
+        std::condition_variable allDone;
+        const std::function<void(size_t, size_t)> *currentTask;
+        size_t taskCount;
+        size_t pending;                      // Workers that have not finished the current generation
+        unsigned long generation;            // Bumped once per parallelFor call to wake the workers
+        bool stopping;
+        vector<std::exception_ptr> errors;   // One slot per chunk
+};
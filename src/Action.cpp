@@ -6,7 +6,6 @@
 // Declare the global backup variable
 extern Simulation* backup;
 
-
 // ---------- BaseAction Implementation ----------
 
 BaseAction::BaseAction() : errorMsg(""), status(ActionStatus::COMPLETED) {}
@@ -30,6 +29,18 @@ const string &BaseAction::getErrorMsg() const {
     return errorMsg;
 }
 
+LogRecord BaseAction::makeRecord(ActionLog &log, ActionKind kind) const {
+    LogRecord record = LogRecord();
+    record.kind = kind;
+    record.status = status;
+    record.repeat = 1;
+    uint32_t empty = log.intern("");
+    record.text[0] = empty;
+    record.text[1] = empty;
+    record.error = log.intern(errorMsg);
+    return record;
+}
+
 
 // ---------- SimulateStep Implementation ----------
 
@@ -37,14 +48,13 @@ const string &BaseAction::getErrorMsg() const {
 SimulateStep::SimulateStep(const int numOfSteps) : numOfSteps(numOfSteps) {}
 
 void SimulateStep::act(Simulation &simulation) {
-    for (int i = 0; i < numOfSteps; i++) {
-        simulation.step();
-    }
+    // Jump straight between events instead of sweeping every plan numOfSteps times
+    simulation.step(numOfSteps);
 
     complete();
 
     // Log a snapshot of the action
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
 }
 
 const string SimulateStep::toString() const {
@@ -61,6 +71,13 @@ SimulateStep *SimulateStep::clone() const {
 }
 
 
+void SimulateStep::appendTo(ActionLog &log) const {
+    LogRecord record = makeRecord(log, ActionKind::STEP);
+    record.values[0] = numOfSteps;
+    log.append(record);
+}
+
+
 // ---------- AddPlan Implementation ----------
 
 AddPlan::AddPlan(const string &settlementName, const string &selectionPolicy)
@@ -76,7 +93,7 @@ void AddPlan::act(Simulation &simulation) {
     if (!simulation.isSettlementExists(settlementName) || !isValidPolicy(selectionPolicy)) {
         error("Cannot create this plan");
         // Log a snapshot of the action 
-        simulation.addAction(this->clone());
+        simulation.addAction(*this);
         return;
     }
 
@@ -89,7 +106,7 @@ void AddPlan::act(Simulation &simulation) {
     complete();
 
     // Log a snapshot of the action
-    simulation.addAction(this->clone());                                  
+    simulation.addAction(*this);                                  
 }
 
 const string AddPlan::toString() const {
@@ -105,22 +122,29 @@ AddPlan *AddPlan::clone() const {
     return new AddPlan(*this);
 }
 
+
+void AddPlan::appendTo(ActionLog &log) const {
+    LogRecord record = makeRecord(log, ActionKind::ADD_PLAN);
+    record.text[0] = log.intern(settlementName);
+    record.text[1] = log.intern(selectionPolicy);
+    log.append(record);
+}
+
 // ---------- AddSettlement Implementation ----------
 AddSettlement::AddSettlement(const string &settlementName, SettlementType settlementType)
     : settlementName(settlementName), settlementType(settlementType) {}
 
 void AddSettlement::act(Simulation &simulation) {
 
-// Create a new settlement
-Settlement *settlement = new Settlement(settlementName, settlementType); 
+// Create a new settlement, the simulation copies it into its own arena
+Settlement settlement(settlementName, settlementType); 
 
 // Attempt to add the settlement to the simulation
 if (!simulation.addSettlement(settlement)) {
-    // If the settlement already exists, clean up and throw an error
-    delete settlement; 
+    // If the settlement already exists, throw an error
     error("Settlement already exists");
     // Log a snapshot of the action 
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
     return;
 }
 
@@ -128,7 +152,7 @@ if (!simulation.addSettlement(settlement)) {
 complete();
 
 // Log a snapshot of the action 
-simulation.addAction(this->clone());
+simulation.addAction(*this);
 }
 
 const string AddSettlement::toString() const {
@@ -144,6 +168,14 @@ AddSettlement *AddSettlement::clone() const {
     return new AddSettlement(*this);
 }
 
+
+void AddSettlement::appendTo(ActionLog &log) const {
+    LogRecord record = makeRecord(log, ActionKind::ADD_SETTLEMENT);
+    record.text[0] = log.intern(settlementName);
+    record.type = static_cast<uint8_t>(settlementType);
+    log.append(record);
+}
+
 // ---------- AddFacility Implementation ----------
 AddFacility::AddFacility(const string &facilityName,
                          const FacilityCategory facilityCategory,
@@ -168,7 +200,7 @@ void AddFacility::act(Simulation &simulation) {
         // If the settlement already exists, clean up and throw an error
         error("Facility already exists");
         // Log a snapshot of the action
-        simulation.addAction(this->clone());
+        simulation.addAction(*this);
         return;
     }
 
@@ -176,7 +208,7 @@ void AddFacility::act(Simulation &simulation) {
     complete();
 
     // Log a snapshot of the action
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
 }
 
 const string AddFacility::toString() const {
@@ -197,16 +229,30 @@ AddFacility *AddFacility::clone() const {
 }
 
 
+void AddFacility::appendTo(ActionLog &log) const {
+    LogRecord record = makeRecord(log, ActionKind::ADD_FACILITY);
+    record.text[0] = log.intern(facilityName);
+    record.type = static_cast<uint8_t>(facilityCategory);
+    record.values[0] = price;
+    record.values[1] = lifeQualityScore;
+    record.values[2] = economyScore;
+    record.values[3] = environmentScore;
+    log.append(record);
+}
+
+
 // ---------- PrintPlanStatus Implementation ----------
 PrintPlanStatus::PrintPlanStatus(int planId) : planId(planId) {}
 
 void PrintPlanStatus::act(Simulation &simulation) {
     try {
-        // Retrieve the plan using the plan ID
-        Plan &plan = simulation.getPlan(planId);
+        // Retrieve the plan using the plan ID. Printing only reads it, so go through the const overload,
+        // which never copies a plan shared with a backup.
+        const Simulation &view = simulation;
+        const Plan &plan = view.getPlan(planId);
 
         // Delegate the printing to the Plan class's printStatus method
-        plan.printStatus();
+        plan.printStatus(view.getFacilitiesOptions());
 
         // Mark the action as completed
         complete();
@@ -216,7 +262,7 @@ void PrintPlanStatus::act(Simulation &simulation) {
     }
 
     // Log a snapshot of the action
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
 }
 
 const string PrintPlanStatus::toString() const {
@@ -232,6 +278,13 @@ PrintPlanStatus* PrintPlanStatus::clone() const {
 }
 
 
+void PrintPlanStatus::appendTo(ActionLog &log) const {
+    LogRecord record = makeRecord(log, ActionKind::PRINT_PLAN_STATUS);
+    record.values[0] = planId;
+    log.append(record);
+}
+
+
 // ---------- ChangePlanPolicy Implementation ----------
 ChangePlanPolicy::ChangePlanPolicy(const int planId, const string &newPolicy) 
     : planId(planId), newPolicy(newPolicy) {}
@@ -247,7 +300,7 @@ void ChangePlanPolicy::act(Simulation &simulation) {
         // Check if the new policy is the same as the current policy
         if (plan.getSelectionPolicy()->toString() == newPolicy) {
             error("Cannot change selection policy");
-            simulation.addAction(this->clone());
+            simulation.addAction(*this);
             return;
         }
 
@@ -259,10 +312,10 @@ void ChangePlanPolicy::act(Simulation &simulation) {
             balancedPolicy->setEnvironmentScore(plan.getEnvironmentScore());
 
             // Add contributions from facilities under construction
-            for (const Facility* facility : plan.getFacilitiesUnderConstruction()) {
-                balancedPolicy->setLifeQualityScore(balancedPolicy->getLifeQualityScore() + facility->getLifeQualityScore());
-                balancedPolicy->setEconomyScore(balancedPolicy->getEconomyScore() + facility->getEconomyScore());
-                balancedPolicy->setEnvironmentScore(balancedPolicy->getEnvironmentScore() + facility->getEnvironmentScore());
+            for (const Facility &facility : plan.getFacilitiesUnderConstruction(simulation.getFacilitiesOptions())) {
+                balancedPolicy->setLifeQualityScore(balancedPolicy->getLifeQualityScore() + facility.getLifeQualityScore());
+                balancedPolicy->setEconomyScore(balancedPolicy->getEconomyScore() + facility.getEconomyScore());
+                balancedPolicy->setEnvironmentScore(balancedPolicy->getEnvironmentScore() + facility.getEnvironmentScore());
             }
         }
 
@@ -277,7 +330,7 @@ void ChangePlanPolicy::act(Simulation &simulation) {
     }
 
     // Log a snapshot of the action
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
 }
 
 const string ChangePlanPolicy::toString() const {
@@ -294,27 +347,38 @@ ChangePlanPolicy* ChangePlanPolicy::clone() const {
 }
 
 
+void ChangePlanPolicy::appendTo(ActionLog &log) const {
+    LogRecord record = makeRecord(log, ActionKind::CHANGE_POLICY);
+    record.values[0] = planId;
+    record.text[1] = log.intern(newPolicy);
+    log.append(record);
+}
+
+
 // ---------- PrintActionsLog Implementation ----------
 
 // Empty constructor
 PrintActionsLog::PrintActionsLog() = default;
 
 void PrintActionsLog::act(Simulation &simulation) {
-    // Print each action in the actions log
-    for (const auto *action : simulation.getActionsLog()) {
-        std::cout << action->toString() << std::endl;
-    }
+    // Print each action in the actions log, folded runs expanded
+    simulation.getActionsLog().print(std::cout);
     // Mark the action as completed
     complete();
 
     // Log the action in the actions log
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
 }
 
  PrintActionsLog* PrintActionsLog::clone() const {
     return new PrintActionsLog(*this); // Deep copy using the copy constructor
 }
 
+
+void PrintActionsLog::appendTo(ActionLog &log) const {
+    log.append(makeRecord(log, ActionKind::PRINT_ACTIONS_LOG));
+}
+
 const string PrintActionsLog::toString() const {
     // This action never results in an error so always completed
     return "log COMPLETED";
@@ -333,13 +397,18 @@ void Close::act(Simulation &simulation) {
     complete();
 
     // Log the action in the actions log
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
 }
 
 Close* Close::clone() const {
     return new Close(*this);
 }
 
+
+void Close::appendTo(ActionLog &log) const {
+    log.append(makeRecord(log, ActionKind::CLOSE));
+}
+
 const std::string Close::toString() const {
      // This action never results in an error so always completed
     return "close COMPLETED";
@@ -356,20 +425,26 @@ void BackupSimulation::act(Simulation &simulation) {
         backup = nullptr;
     }
 
-    // Create a new backup as a deep copy of the current simulation
+    // Create a new backup as a copy of the current simulation. The copy shares the state and copies it on write,
+    // so this is O(1) and the backup only costs memory for what changes afterwards.
     backup = new Simulation(simulation);
 
     // Mark the action as completed
     complete();
 
     // Log the action in the actions log
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
 }
 
 BackupSimulation* BackupSimulation::clone() const {
     return new BackupSimulation(*this);
 }
 
+
+void BackupSimulation::appendTo(ActionLog &log) const {
+    log.append(makeRecord(log, ActionKind::BACKUP));
+}
+
 const std::string BackupSimulation::toString() const {
     // This action never results in an error so always completed
     return "backup COMPLETED";
@@ -385,12 +460,12 @@ void RestoreSimulation::act(Simulation &simulation) {
     // Check if a backup exists
     if (backup == nullptr) {
         error("No backup available");
-        simulation.addAction(this->clone());
+        simulation.addAction(*this);
         return;
     }
 
     // Overwrite the current simulation with the backup
-    // Use copy assingment operator
+    // Use copy assingment operator, which only swaps in the backup's shared state
     simulation = *backup;
 
     // Mark the action as completed
@@ -400,13 +475,18 @@ void RestoreSimulation::act(Simulation &simulation) {
     simulation.open();
 
     // Log the action in the actions log
-    simulation.addAction(this->clone());
+    simulation.addAction(*this);
 }
 
 RestoreSimulation* RestoreSimulation::clone() const {
     return new RestoreSimulation(*this);
 }
 
+
+void RestoreSimulation::appendTo(ActionLog &log) const {
+    log.append(makeRecord(log, ActionKind::RESTORE));
+}
+
 const std::string RestoreSimulation::toString() const {
     std::ostringstream oss;
     oss << "restore "
@@ -415,3 +495,84 @@ const std::string RestoreSimulation::toString() const {
 }
 
 
+// ---------- SaveSnapshot Implementation ----------
+
+SaveSnapshot::SaveSnapshot(const string &path) : path(path) {}
+
+void SaveSnapshot::act(Simulation &simulation) {
+    try {
+        // The backup is saved along with the simulation, so that it survives a restart too
+        simulation.saveSnapshot(path, backup);
+        complete();
+    } catch (const std::exception &e) {
+        error(e.what());
+    }
+
+    // Log the action in the actions log
+    simulation.addAction(*this);
+}
+
+SaveSnapshot *SaveSnapshot::clone() const {
+    return new SaveSnapshot(*this);
+}
+
+
+void SaveSnapshot::appendTo(ActionLog &log) const {
+    LogRecord record = makeRecord(log, ActionKind::SAVE);
+    record.text[0] = log.intern(path);
+    log.append(record);
+}
+
+const string SaveSnapshot::toString() const {
+    std::ostringstream oss;
+    oss << "save "
+        << path << " "
+        << (getStatus() == ActionStatus::COMPLETED ? "COMPLETED" : "ERROR");
+    return oss.str();
+}
+
+
+// ---------- LoadSnapshot Implementation ----------
+
+LoadSnapshot::LoadSnapshot(const string &path) : path(path) {}
+
+void LoadSnapshot::act(Simulation &simulation) {
+    try {
+        // Read everything first, a corrupt file leaves the current simulation and backup untouched
+        Simulation *loadedBackup = nullptr;
+        Simulation loaded = Simulation::loadSnapshot(path, loadedBackup);
+
+        // Copy assignment only shares the loaded state and keeps our worker threads
+        simulation = loaded;
+        delete backup;
+        backup = loadedBackup;
+
+        // The simulation keeps running whatever its state was when saved
+        simulation.open();
+        complete();
+    } catch (const std::exception &e) {
+        error(e.what());
+    }
+
+    // Log the action in the actions log
+    simulation.addAction(*this);
+}
+
+LoadSnapshot *LoadSnapshot::clone() const {
+    return new LoadSnapshot(*this);
+}
+
+
+void LoadSnapshot::appendTo(ActionLog &log) const {
+    LogRecord record = makeRecord(log, ActionKind::LOAD);
+    record.text[0] = log.intern(path);
+    log.append(record);
+}
+
+const string LoadSnapshot::toString() const {
+    std::ostringstream oss;
+    oss << "load "
+        << path << " "
+        << (getStatus() == ActionStatus::COMPLETED ? "COMPLETED" : "ERROR");
+    return oss.str();
+}
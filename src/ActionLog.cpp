@@ -0,0 +1,201 @@
+#include "ActionLog.h"
+#include <sstream>
+
+namespace {
+bool sameAction(const LogRecord &a, const LogRecord &b) {
+    return a.kind == b.kind && a.status == b.status && a.type == b.type &&
+           a.text[0] == b.text[0] && a.text[1] == b.text[1] && a.error == b.error &&
+           a.values[0] == b.values[0] && a.values[1] == b.values[1] &&
+           a.values[2] == b.values[2] && a.values[3] == b.values[3];
+}
+
+const char *statusName(const LogRecord &record) {
+    return record.status == ActionStatus::COMPLETED ? "COMPLETED" : "ERROR";
+}
+}
+
+//-----------ActionLog implementation-----------
+
+ActionLog::StringTable::StringTable() : strings(), ids() {}
+
+ActionLog::ActionLog() : records(), actionCount(0), table(std::make_shared<StringTable>()) {}
+
+size_t ActionLog::size() const {
+    return actionCount;
+}
+
+size_t ActionLog::recordCount() const {
+    return records.size();
+}
+
+uint32_t ActionLog::intern(const string &text) {
+    auto found = table->ids.find(text);
+    if (found != table->ids.end()) {
+        return found->second;
+    }
+    uint32_t id = static_cast<uint32_t>(table->strings.size());
+    table->strings.push_back(text);
+    table->ids.emplace(text, id);
+    return id;
+}
+
+void ActionLog::append(const LogRecord &record) {
+    actionCount += record.repeat;
+    size_t count = records.size();
+    if (count > 0 && sameAction(records[count - 1], record)) {
+        records.mutate(count - 1).repeat += record.repeat;
+        return;
+    }
+    records.push_back(record);
+}
+
+string ActionLog::toString(const LogRecord &record) const {
+    const vector<string> &strings = table->strings;
+    std::ostringstream oss;
+    switch (record.kind) {
+        case ActionKind::STEP:
+            // This action never results in an error so always completed
+            oss << "step " << record.values[0] << " COMPLETED";
+            break;
+        case ActionKind::ADD_PLAN:
+            oss << "plan " << strings[record.text[0]] << " " << strings[record.text[1]] << " " << statusName(record);
+            break;
+        case ActionKind::ADD_SETTLEMENT:
+            oss << "settlement " << strings[record.text[0]] << " " << static_cast<int>(record.type) << " "
+                << statusName(record);
+            break;
+        case ActionKind::ADD_FACILITY:
+            oss << "facility " << strings[record.text[0]] << " " << static_cast<int>(record.type) << " "
+                << record.values[0] << " " << record.values[1] << " " << record.values[2] << " "
+                << record.values[3] << " " << statusName(record);
+            break;
+        case ActionKind::PRINT_PLAN_STATUS:
+            oss << "planStatus " << record.values[0] << " " << statusName(record);
+            break;
+        case ActionKind::CHANGE_POLICY:
+            oss << "changePolicy " << record.values[0] << " " << strings[record.text[1]] << " " << statusName(record);
+            break;
+        case ActionKind::PRINT_ACTIONS_LOG:
+            oss << "log COMPLETED";
+            break;
+        case ActionKind::CLOSE:
+            oss << "close COMPLETED";
+            break;
+        case ActionKind::BACKUP:
+            oss << "backup COMPLETED";
+            break;
+        case ActionKind::RESTORE:
+            oss << "restore " << statusName(record);
+            break;
+        case ActionKind::SAVE:
+            oss << "save " << strings[record.text[0]] << " " << statusName(record);
+            break;
+        case ActionKind::LOAD:
+            oss << "load " << strings[record.text[0]] << " " << statusName(record);
+            break;
+    }
+    return oss.str();
+}
+
+void ActionLog::print(std::ostream &out) const {
+    // A folded run is formatted once and written repeat times
+    for (size_t i = 0; i < records.size(); i++) {
+        const LogRecord &record = records[i];
+        string line = toString(record);
+        for (uint32_t j = 0; j < record.repeat; j++) {
+            out << line << '\n';
+        }
+    }
+    out.flush();
+}
+
+void ActionLog::clear() {
+    records.clear();
+    actionCount = 0;
+    table = std::make_shared<StringTable>();
+}
+
+void ActionLog::save(SnapshotWriter &out) const {
+    // The table may hold strings interned by other copies, only the ones our records use are written,
+    // renumbered in order of first use
+    std::unordered_map<uint32_t, uint32_t> renumbered;
+    vector<uint32_t> used;
+    auto renumber = [&renumbered, &used](uint32_t id) {
+        auto inserted = renumbered.emplace(id, static_cast<uint32_t>(used.size()));
+        if (inserted.second) {
+            used.push_back(id);
+        }
+        return inserted.first->second;
+    };
+    vector<LogRecord> written;
+    written.reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        LogRecord record = records[i];
+        record.text[0] = renumber(record.text[0]);
+        record.text[1] = renumber(record.text[1]);
+        record.error = renumber(record.error);
+        written.push_back(record);
+    }
+
+    out.writeU32(static_cast<uint32_t>(used.size()));
+    for (uint32_t id : used) {
+        out.writeString(table->strings[id]);
+    }
+    out.writeU32(static_cast<uint32_t>(written.size()));
+    for (const LogRecord &record : written) {
+        out.writeU8(static_cast<uint8_t>(record.kind));
+        out.writeU8(static_cast<uint8_t>(record.status));
+        out.writeU8(record.type);
+        out.writeU32(record.repeat);
+        out.writeU32(record.text[0]);
+        out.writeU32(record.text[1]);
+        out.writeU32(record.error);
+        for (int32_t value : record.values) {
+            out.writeI32(value);
+        }
+    }
+}
+
+ActionLog::ActionLog(SnapshotReader &in) : records(), actionCount(0), table(std::make_shared<StringTable>()) {
+    uint32_t stringCount = in.readU32();
+    for (uint32_t i = 0; i < stringCount; i++) {
+        // Ids are positions in the file, so duplicates keep theirs and only the first one is found by intern()
+        string text = in.readString();
+        table->ids.emplace(text, i);
+        table->strings.push_back(std::move(text));
+    }
+
+    uint32_t recordCount = in.readU32();
+    for (uint32_t i = 0; i < recordCount; i++) {
+        LogRecord record = LogRecord();
+        uint8_t kind = in.readU8();
+        if (kind > static_cast<uint8_t>(ActionKind::LOAD)) {
+            in.corrupt("unknown action kind");
+        }
+        uint8_t status = in.readU8();
+        if (status > static_cast<uint8_t>(ActionStatus::ERROR)) {
+            in.corrupt("invalid action status");
+        }
+        record.kind = static_cast<ActionKind>(kind);
+        record.status = static_cast<ActionStatus>(status);
+        record.type = in.readU8();
+        if (record.type > 2) {
+            in.corrupt("invalid settlement type or facility category");
+        }
+        record.repeat = in.readU32();
+        if (record.repeat == 0) {
+            in.corrupt("empty action run");
+        }
+        record.text[0] = in.readU32();
+        record.text[1] = in.readU32();
+        record.error = in.readU32();
+        if (record.text[0] >= stringCount || record.text[1] >= stringCount || record.error >= stringCount) {
+            in.corrupt("action string out of range");
+        }
+        for (int32_t &value : record.values) {
+            value = in.readI32();
+        }
+        records.push_back(record);
+        actionCount += record.repeat;
+    }
+}
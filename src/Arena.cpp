@@ -0,0 +1,133 @@
+#include "Arena.h"
+
+//-----------Arena implementation-----------
+
+// Constructor: no block is reserved until the first object is created
+Arena::Arena(size_t blockSize)
+    : blockSize(blockSize),
+      blocks(),
+      cursor(nullptr),
+      limit(nullptr),
+      finalizers(),
+      liveObjects(0),
+      liveBytes(0),
+      reservedBytes(0),
+      totalAllocations(0) {}
+
+// Move Constructor: the blocks change owner, objects keep their addresses
+Arena::Arena(Arena &&other)
+    : blockSize(other.blockSize),
+      blocks(std::move(other.blocks)),
+      cursor(other.cursor),
+      limit(other.limit),
+      finalizers(std::move(other.finalizers)),
+      liveObjects(other.liveObjects),
+      liveBytes(other.liveBytes),
+      reservedBytes(other.reservedBytes),
+      totalAllocations(other.totalAllocations)
+{
+    // Leave `other` empty so its destructor releases nothing
+    other.blocks.clear();
+    other.finalizers.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.liveObjects = 0;
+    other.liveBytes = 0;
+    other.reservedBytes = 0;
+}
+
+// Move Assignment Operator
+Arena &Arena::operator=(Arena &&other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    // Release our own objects before taking over the blocks of `other`
+    reset();
+
+    blockSize = other.blockSize;
+    blocks = std::move(other.blocks);
+    cursor = other.cursor;
+    limit = other.limit;
+    finalizers = std::move(other.finalizers);
+    liveObjects = other.liveObjects;
+    liveBytes = other.liveBytes;
+    reservedBytes = other.reservedBytes;
+    totalAllocations += other.totalAllocations;
+
+    other.blocks.clear();
+    other.finalizers.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.liveObjects = 0;
+    other.liveBytes = 0;
+    other.reservedBytes = 0;
+    return *this;
+}
+
+// Destructor
+Arena::~Arena() {
+    reset();
+}
+
+void Arena::reset() {
+    // Objects may refer to objects created before them, so destroy the newest first
+    for (size_t i = finalizers.size(); i-- > 0;) {
+        finalizers[i].destroy(finalizers[i].object);
+    }
+    finalizers.clear();
+    releaseBlocks();
+    liveObjects = 0;
+    liveBytes = 0;
+}
+
+void Arena::releaseBlocks() {
+    for (char *block : blocks) {
+        delete[] block;
+    }
+    blocks.clear();
+    cursor = nullptr;
+    limit = nullptr;
+    reservedBytes = 0;
+}
+
+void *Arena::allocate(size_t size, size_t alignment) {
+    // Round the cursor up to the requested alignment
+    size_t padding = cursor ? (alignment - reinterpret_cast<size_t>(cursor) % alignment) % alignment : 0;
+
+    if (cursor == nullptr || size + padding > static_cast<size_t>(limit - cursor)) {
+        // Oversized objects get a block of their own. new[] returns memory aligned for any fundamental type.
+        size_t newBlockSize = (size > blockSize) ? size : blockSize;
+        char *block = new char[newBlockSize];
+        blocks.push_back(block);
+        reservedBytes += newBlockSize;
+        cursor = block;
+        limit = block + newBlockSize;
+        padding = 0;
+    }
+
+    void *memory = cursor + padding;
+    cursor += padding + size;
+    liveBytes += size;
+    return memory;
+}
+
+size_t Arena::getLiveObjects() const {
+    return liveObjects;
+}
+
+size_t Arena::getLiveBytes() const {
+    return liveBytes;
+}
+
+size_t Arena::getReservedBytes() const {
+    return reservedBytes;
+}
+
+size_t Arena::getBlockCount() const {
+    return blocks.size();
+}
+
+size_t Arena::getTotalAllocations() const {
+    return totalAllocations;
+}
@@ -0,0 +1,137 @@
+#include "BatchIO.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h> // read, write, close
+
+//-----------LineReader implementation-----------
+
+const size_t LineReader::BLOCK_SIZE;
+
+LineReader::LineReader(int fd, bool ownsFd)
+    : fd(fd), ownsFd(ownsFd), buffer(BLOCK_SIZE), begin(0), end(0), finished(false), complete(true) {}
+
+LineReader::~LineReader() {
+    if (ownsFd) {
+        ::close(fd);
+    }
+}
+
+bool LineReader::nextLine(string &line) {
+    size_t searched = begin; // Bytes before this are known not to hold a '\n'
+    while (true) {
+        const char *start = buffer.data() + begin;
+        const char *newline = static_cast<const char*>(std::memchr(buffer.data() + searched, '\n', end - searched));
+        if (newline != nullptr) {
+            line.assign(start, newline);
+            begin = (newline - buffer.data()) + 1;
+            complete = true;
+            return true;
+        }
+        searched = end - begin; // fill() moves the unread bytes to the front
+        if (!fill()) {
+            // The last line may not end with a newline
+            if (begin == end) {
+                return false;
+            }
+            line.assign(buffer.data() + begin, buffer.data() + end);
+            begin = end;
+            complete = false;
+            return true;
+        }
+    }
+}
+
+bool LineReader::lastLineComplete() const {
+    return complete;
+}
+
+bool LineReader::fill() {
+    if (finished) {
+        return false;
+    }
+    // Keep the start of the current line, growing the buffer if a single line fills it
+    std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+    end -= begin;
+    begin = 0;
+    if (end == buffer.size()) {
+        buffer.resize(buffer.size() * 2);
+    }
+
+    ssize_t count;
+    do {
+        count = ::read(fd, buffer.data() + end, buffer.size() - end);
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) {
+        finished = true;
+        return false;
+    }
+    end += static_cast<size_t>(count);
+    return true;
+}
+
+//-----------BufferedOutput implementation-----------
+
+const size_t BufferedOutput::BUFFER_SIZE;
+
+BufferedOutput::BufferedOutput(int fd) : std::streambuf(), fd(fd), buffer(BUFFER_SIZE) {
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+BufferedOutput::~BufferedOutput() {
+    flush();
+}
+
+void BufferedOutput::flush() {
+    writeAll(pbase(), pptr() - pbase());
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+void BufferedOutput::flush(std::ostream &stream) {
+    BufferedOutput *output = dynamic_cast<BufferedOutput*>(stream.rdbuf());
+    if (output != nullptr) {
+        output->flush();
+    } else {
+        stream.flush();
+    }
+}
+
+BufferedOutput::int_type BufferedOutput::overflow(int_type ch) {
+    flush();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize BufferedOutput::xsputn(const char *data, std::streamsize count) {
+    size_t size = static_cast<size_t>(count);
+    if (size > static_cast<size_t>(epptr() - pptr())) {
+        flush();
+        if (size >= buffer.size()) {
+            writeAll(data, size); // Too large to be worth copying
+            return count;
+        }
+    }
+    std::memcpy(pptr(), data, size);
+    pbump(static_cast<int>(size));
+    return count;
+}
+
+int BufferedOutput::sync() {
+    return 0; // Flushing the stream is what the buffer saves, only a full buffer or flush() writes
+}
+
+void BufferedOutput::writeAll(const char *data, size_t count) {
+    while (count > 0) {
+        ssize_t written = ::write(fd, data, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; // The output is gone (e.g. a closed pipe), drop the rest like an unchecked std::cout would
+        }
+        data += written;
+        count -= static_cast<size_t>(written);
+    }
+}
@@ -0,0 +1,218 @@
+#include "ConfigLoader.h"
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+// Same characters as the whitespace std::istringstream splits on in the C locale
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// Parses a number the way std::stoi does: an optional sign followed by digits, ignoring anything after them.
+// Returns false if there are no digits or the number does not fit an int.
+bool parseInt(const ConfigToken &token, int &value) {
+    const char *cursor = token.data;
+    const char *end = token.data + token.length;
+    bool negative = false;
+    if (cursor != end && (*cursor == '+' || *cursor == '-')) {
+        negative = (*cursor == '-');
+        cursor++;
+    }
+    if (cursor == end || *cursor < '0' || *cursor > '9') {
+        return false;
+    }
+    long long magnitude = 0;
+    while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+        magnitude = magnitude * 10 + (*cursor - '0');
+        if (magnitude > static_cast<long long>(INT_MAX) + 1) {
+            return false;
+        }
+        cursor++;
+    }
+    long long result = negative ? -magnitude : magnitude;
+    if (result > INT_MAX) {
+        return false;
+    }
+    value = static_cast<int>(result);
+    return true;
+}
+
+const size_t MAX_TOKENS = 7; // The longest entry is a facility
+}
+
+//-----------ConfigToken implementation-----------
+
+string ConfigToken::str() const {
+    return string(data, length);
+}
+
+bool ConfigToken::equals(const char *text) const {
+    return std::strlen(text) == length && std::memcmp(data, text, length) == 0;
+}
+
+//-----------ConfigChunk implementation-----------
+
+ConfigChunk::ConfigChunk()
+    : entries(), firstLine(1), lineCount(0), failed(false), errorLine(0), errorMessage() {}
+
+//-----------ConfigLoader implementation-----------
+
+const size_t ConfigLoader::PARALLEL_THRESHOLD;
+
+ConfigLoader::ConfigLoader(const string &path) : file(path), chunks() {
+    if (!file.isOpen()) {
+        throw std::runtime_error("Failed to open configuration file."); // Ensure the file is accessible
+    }
+}
+
+size_t ConfigLoader::getSize() const {
+    return file.size();
+}
+
+void ConfigLoader::parse(ThreadPool *pool) {
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+    size_t count = (pool != nullptr && file.size() >= PARALLEL_THRESHOLD) ? static_cast<size_t>(pool->size()) : 1;
+
+    // Cut the file into roughly equal chunks, moving every cut to the start of the next line
+    vector<const char*> bounds(count + 1, begin);
+    bounds[count] = end;
+    for (size_t i = 1; i < count; i++) {
+        const char *cut = begin + file.size() / count * i;
+        if (cut < bounds[i - 1]) {
+            cut = bounds[i - 1];
+        }
+        const char *newline = (cut == end) ? nullptr : static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+        bounds[i] = (newline == nullptr) ? end : newline + 1;
+    }
+
+    chunks.assign(count, ConfigChunk());
+    if (count == 1) {
+        parseChunk(begin, end, chunks[0]);
+    } else {
+        pool->parallelFor(count, [this, &bounds](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                parseChunk(bounds[i], bounds[i + 1], chunks[i]);
+            }
+        });
+    }
+
+    // Chunks count their lines from 0, turn that into line numbers in the file
+    size_t line = 1;
+    for (ConfigChunk &chunk : chunks) {
+        chunk.firstLine = line;
+        if (chunk.failed) {
+            chunk.errorLine += line;
+        }
+        line += chunk.lineCount;
+    }
+}
+
+const vector<ConfigChunk> &ConfigLoader::getChunks() const {
+    return chunks;
+}
+
+void ConfigLoader::parseChunk(const char *begin, const char *end, ConfigChunk &chunk) const {
+    ConfigToken tokens[MAX_TOKENS + 1] = {};
+    const char *lineStart = begin;
+    while (lineStart < end) {
+        const char *newline = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+        const char *lineEnd = (newline == nullptr) ? end : newline;
+        uint32_t line = static_cast<uint32_t>(chunk.lineCount++);
+        const char *next = lineEnd + 1;
+
+        // Ignore comments (lines starting with '#') and blank lines
+        if (lineStart == lineEnd || *lineStart == '#') {
+            lineStart = next;
+            continue;
+        }
+
+        // Tokenize in place. One token more than the longest entry is enough to tell that a line is too long.
+        size_t tokenCount = 0;
+        const char *cursor = lineStart;
+        while (cursor < lineEnd && tokenCount <= MAX_TOKENS) {
+            while (cursor < lineEnd && isSpace(*cursor)) {
+                cursor++;
+            }
+            if (cursor == lineEnd) {
+                break;
+            }
+            const char *tokenStart = cursor;
+            while (cursor < lineEnd && !isSpace(*cursor)) {
+                cursor++;
+            }
+            tokens[tokenCount].data = tokenStart;
+            tokens[tokenCount].length = static_cast<uint32_t>(cursor - tokenStart);
+            tokenCount++;
+        }
+        if (tokenCount == 0) {
+            lineStart = next;
+            continue; // Skip lines made of whitespace only
+        }
+
+        ConfigEntry entry = ConfigEntry();
+        entry.line = line;
+        const char *errorMessage = nullptr;
+        string errorDetail;
+        const ConfigToken &kind = tokens[0];
+
+        if (kind.equals("settlement")) {
+            entry.type = ConfigEntryType::SETTLEMENT;
+            entry.name = tokens[1];
+            if (tokenCount != 3) {
+                errorMessage = "Invalid settlement format in config file.";
+            } else if (!parseInt(tokens[2], entry.values[0])) {
+                errorMessage = "Invalid number in config file: ";
+                errorDetail = tokens[2].str();
+            } else if (entry.values[0] < 0 || entry.values[0] > 2) {
+                errorMessage = "Invalid value for SettlementType";
+            }
+        } else if (kind.equals("facility")) {
+            entry.type = ConfigEntryType::FACILITY;
+            entry.name = tokens[1];
+            if (tokenCount != 7) {
+                errorMessage = "Invalid facility format in config file.";
+            } else {
+                for (size_t i = 0; i < 5 && errorMessage == nullptr; i++) {
+                    if (!parseInt(tokens[i + 2], entry.values[i])) {
+                        errorMessage = "Invalid number in config file: ";
+                        errorDetail = tokens[i + 2].str();
+                    }
+                }
+                if (errorMessage == nullptr && (entry.values[0] < 0 || entry.values[0] > 2)) {
+                    errorMessage = "Invalid value for FacilityCategory";
+                }
+            }
+        } else if (kind.equals("plan")) {
+            entry.type = ConfigEntryType::PLAN;
+            entry.name = tokens[1];
+            entry.policy = tokens[2];
+            if (tokenCount != 3) {
+                errorMessage = "Invalid plan format in config file.";
+            } else if (!entry.policy.equals("nve") && !entry.policy.equals("bal") &&
+                       !entry.policy.equals("eco") && !entry.policy.equals("env")) {
+                errorMessage = "Invalid selection policy: ";
+                errorDetail = entry.policy.str();
+            }
+        } else if (kind.equals("threads")) {
+            entry.type = ConfigEntryType::THREADS;
+            if (tokenCount != 2 || !parseInt(tokens[1], entry.values[0]) || entry.values[0] < 1) {
+                errorMessage = "Invalid threads format in config file.";
+            }
+        } else {
+            errorMessage = "Unknown configuration entry type: "; // Handle unknown entries
+            errorDetail = kind.str();
+        }
+
+        if (errorMessage != nullptr) {
+            // Stop at the first malformed line, nothing after it is applied anyway
+            chunk.failed = true;
+            chunk.errorLine = line;
+            chunk.errorMessage = errorMessage + errorDetail;
+            return;
+        }
+        chunk.entries.push_back(entry);
+        lineStart = next;
+    }
+}
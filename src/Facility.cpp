@@ -76,6 +76,15 @@ FacilityStatus Facility::step() {
     return status;
 }
 
+FacilityStatus Facility::advance(int ticks) {
+    // Each step() decrements until timeLeft hits 0, so the whole countdown collapses into one subtraction
+    timeLeft = (ticks < timeLeft) ? timeLeft - ticks : 0;
+    if (timeLeft == 0) {
+        status = FacilityStatus::OPERATIONAL;
+    }
+    return status;
+}
+
 const string Facility::toString() const {
     std::ostringstream output;
 
@@ -0,0 +1,90 @@
+#include "Journal.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>  // open
+#include <unistd.h> // write, ftruncate, fdatasync, close
+
+//-----------Journal implementation-----------
+
+const size_t Journal::GROUP_COMMANDS;
+const size_t Journal::GROUP_BYTES;
+const std::chrono::milliseconds Journal::GROUP_INTERVAL(10);
+
+Journal::Journal(const string &path, size_t keepBytes)
+    : path(path), fd(-1), pending(), pendingCommands(0), oldestPending(), commandCount(0), commitCount(0) {
+    // O_APPEND, so every group lands after the kept part whatever the file offset
+    int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (file < 0) {
+        return;
+    }
+    // Cut off whatever follows the kept part, such as a line torn by a crash
+    if (::ftruncate(file, static_cast<off_t>(keepBytes)) != 0) {
+        ::close(file);
+        return;
+    }
+    fd = file;
+}
+
+Journal::~Journal() {
+    if (fd < 0) {
+        return;
+    }
+    try {
+        commit();
+    } catch (const std::exception &) {
+        // Nothing left to report the error to, the recovery ignores a torn last line
+    }
+    ::close(fd);
+}
+
+bool Journal::isOpen() const {
+    return fd >= 0;
+}
+
+void Journal::append(const string &command) {
+    if (pendingCommands == 0) {
+        oldestPending = std::chrono::steady_clock::now();
+    }
+    pending += command;
+    pending += '\n';
+    pendingCommands++;
+    commandCount++;
+
+    if (pendingCommands >= GROUP_COMMANDS || pending.size() >= GROUP_BYTES ||
+        std::chrono::steady_clock::now() - oldestPending >= GROUP_INTERVAL) {
+        commit();
+    }
+}
+
+void Journal::commit() {
+    if (pendingCommands == 0) {
+        return;
+    }
+    size_t done = 0;
+    while (done < pending.size()) {
+        ssize_t written = ::write(fd, pending.data() + done, pending.size() - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            pending.erase(0, done); // Keep only what did not make it, so a later commit does not write it twice
+            throw std::runtime_error("Failed to write journal " + path + ": " + std::strerror(errno));
+        }
+        done += static_cast<size_t>(written);
+    }
+    pending.clear();
+    pendingCommands = 0;
+    if (::fdatasync(fd) != 0) {
+        throw std::runtime_error("Failed to sync journal " + path + ": " + std::strerror(errno));
+    }
+    commitCount++;
+}
+
+size_t Journal::getCommandCount() const {
+    return commandCount;
+}
+
+size_t Journal::getCommitCount() const {
+    return commitCount;
+}
@@ -0,0 +1,51 @@
+#include "MappedFile.h"
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+//-----------MappedFile implementation-----------
+
+MappedFile::MappedFile(const string &path) : opened(false), contents(nullptr), length(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return;
+    }
+
+    // mmap rejects empty mappings, an empty file is simply open with no contents
+    size_t fileSize = static_cast<size_t>(info.st_size);
+    if (fileSize > 0) {
+        void *mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            return;
+        }
+        contents = static_cast<const char*>(mapping);
+        length = fileSize;
+    }
+    ::close(fd); // The mapping stays valid after the descriptor is closed
+    opened = true;
+}
+
+MappedFile::~MappedFile() {
+    if (contents != nullptr) {
+        ::munmap(const_cast<char*>(contents), length);
+    }
+}
+
+bool MappedFile::isOpen() const {
+    return opened;
+}
+
+const char *MappedFile::data() const {
+    return contents;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
@@ -2,21 +2,24 @@
 #include <iostream>
 #include <stdexcept>
 #include <sstream> // For std::ostringstream
+#include <algorithm> // For std::min and std::max
 
 //-----------Plan implementation-----------
 
 // Constructor
-Plan::Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const vector<FacilityType> &facilityOptions)
+Plan::Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy)
     : plan_id(planId),
       settlement(settlement),
       selectionPolicy(selectionPolicy),
       status(PlanStatus::AVALIABLE),
-      facilities(),
-      underConstruction(),
-      facilityOptions(facilityOptions),
       life_quality_score(0),
       economy_score(0),
-      environment_score(0) {
+      environment_score(0),
+      clock(0),
+      facilityTypes(),
+      constructionTypes(),
+      constructionDue(),
+      nextDue(0) {
 }
 
 // Copy Constructor
@@ -27,20 +30,15 @@ Plan::Plan(const Plan &other)
       // Create a deep copy of the selection policy using its `clone` method
       selectionPolicy(other.selectionPolicy->clone()),
       status(other.status),
-      facilities(),
-      underConstruction(),
-      facilityOptions(other.facilityOptions),
       life_quality_score(other.life_quality_score),
       economy_score(other.economy_score),
-      environment_score(other.environment_score) {
-
-    // Deep copy facilities and underConstruction to avoid shared ownership of dynamically allocated objects
-    for (Facility *facility : other.facilities) {
-        facilities.push_back(new Facility(*facility));
-    }
-    for (Facility *facility : other.underConstruction) {
-        underConstruction.push_back(new Facility(*facility));
-    }
+      environment_score(other.environment_score),
+      clock(other.clock),
+      // The facility store holds plain indices, so copying the vectors is a deep copy
+      facilityTypes(other.facilityTypes),
+      constructionTypes(other.constructionTypes),
+      constructionDue(other.constructionDue),
+      nextDue(other.nextDue) {
 }
 
 // Copy Constructor with settlement: Allows copying a plan while associating it with a new settlement refrence.
@@ -51,20 +49,15 @@ Plan::Plan(const Plan &other, const Settlement &settlement)
       // Create a deep copy of the selection policy using its `clone` method
       selectionPolicy(other.selectionPolicy->clone()),
       status(other.status),
-      facilities(),
-      underConstruction(),
-      facilityOptions(other.facilityOptions),
       life_quality_score(other.life_quality_score),
       economy_score(other.economy_score),
-      environment_score(other.environment_score) {
-
-    // Deep copy facilities and underConstruction to avoid shared ownership of dynamically allocated objects
-    for (Facility *facility : other.facilities) {
-        facilities.push_back(new Facility(*facility));
-    }
-    for (Facility *facility : other.underConstruction) {
-        underConstruction.push_back(new Facility(*facility));
-    }
+      environment_score(other.environment_score),
+      clock(other.clock),
+      // The facility store holds plain indices, so copying the vectors is a deep copy
+      facilityTypes(other.facilityTypes),
+      constructionTypes(other.constructionTypes),
+      constructionDue(other.constructionDue),
+      nextDue(other.nextDue) {
 }
 
 // Move Constructor
@@ -74,17 +67,20 @@ Plan::Plan(Plan &&other)
       settlement(other.settlement), // Transfer reference to the same settlement
       selectionPolicy(other.selectionPolicy), // Take ownership of the selection policy
       status(other.status),
-      // Use std::move to transfer ownership of dynamic resources efficiently
-      facilities(std::move(other.facilities)),
-      underConstruction(std::move(other.underConstruction)),
-      facilityOptions(other.facilityOptions), // Copy the reference to facility options
       life_quality_score(other.life_quality_score),
       economy_score(other.economy_score),
-      environment_score(other.environment_score)
+      environment_score(other.environment_score),
+      clock(other.clock),
+      // Use std::move to transfer the facility store efficiently
+      facilityTypes(std::move(other.facilityTypes)),
+      constructionTypes(std::move(other.constructionTypes)),
+      constructionDue(std::move(other.constructionDue)),
+      nextDue(other.nextDue)
 {
     other.selectionPolicy = nullptr;      // Prevent double deletion of selectionPolicy
-    other.facilities.clear();             // Leave `other` in a valid empty state
-    other.underConstruction.clear();      // Leave `other` in a valid empty state
+    other.facilityTypes.clear();          // Leave `other` in a valid empty state
+    other.constructionTypes.clear();      // Leave `other` in a valid empty state
+    other.constructionDue.clear();        // Leave `other` in a valid empty state
     other.status = PlanStatus::AVALIABLE; // Reset `other` to a default state
 }
 
@@ -92,21 +88,9 @@ Plan::Plan(Plan &&other)
 Plan::~Plan() {
     // Note: No need to check for nullptr before delete, since in modern C++ delete does nothing if the pointer is null
 
-    // Delete the selection policy
+    // Delete the selection policy, the facility store holds no dynamically allocated objects
     delete selectionPolicy;
     selectionPolicy = nullptr; // Nullify the pointer to avoid accidental reuse
-
-    // Free dynamically allocated memory
-    for (Facility *facility : facilities) {
-        delete facility;
-    }
-    facilities.clear(); // Remove all elements from the vector, avoiding dangling pointers to freed memory
-
-    // Free dynamically allocated memory
-    for (Facility *facility : underConstruction) {
-        delete facility;
-    }
-    underConstruction.clear(); // Remove all elements from the vector, avoiding dangling pointers to freed memory
 }
 
 // Getter methods
@@ -122,7 +106,11 @@ const int Plan::getEnvironmentScore() const {
     return environment_score;
 }
 
-const vector<Facility*> &Plan::getFacilities() const {
+vector<Facility> Plan::getFacilities(const vector<FacilityType> &facilityOptions) const {
+    vector<Facility> facilities;
+    for (int typeId : facilityTypes) {
+        facilities.push_back(buildFacility(facilityOptions, typeId, clock));
+    }
     return facilities;
 }
 
@@ -141,8 +129,12 @@ const SelectionPolicy* Plan::getSelectionPolicy() const {
     return selectionPolicy;
 }
 
-// Getter for underConstruction vector
-const vector<Facility*>& Plan::getFacilitiesUnderConstruction() const {
+// Getter for the facilities under construction, in selection order
+vector<Facility> Plan::getFacilitiesUnderConstruction(const vector<FacilityType> &facilityOptions) const {
+    vector<Facility> underConstruction;
+    for (size_t i = 0; i < constructionTypes.size(); i++) {
+        underConstruction.push_back(buildFacility(facilityOptions, constructionTypes[i], constructionDue[i]));
+    }
     return underConstruction;
 }
 
@@ -155,7 +147,7 @@ void Plan::setSelectionPolicy(SelectionPolicy *newPolicy)
     selectionPolicy = newPolicy; // Assign the new policy
 }
 
-void Plan::step() {
+void Plan::step(const vector<FacilityType> &facilityOptions) {
     // Stage 1: Check if the plan is available to proceed with construction
     if (status == PlanStatus::AVALIABLE) {
         // Stage 2: Use the selection policy to choose facilities for construction, repeating until the settlement's construction limit is reached. 
@@ -165,48 +157,93 @@ void Plan::step() {
         // can be used for arithmetic operations and compared with the vector's size.
         size_t maxConstruction = static_cast<size_t>(settlement.getType()) + 1;
 
-        while (underConstruction.size() < maxConstruction) {
-            // Select a facility according to the selection policy
-            FacilityType chosenType = selectionPolicy->selectFacility(facilityOptions);
-
-            // Dynamically create a new Facility instance based on the selected type
-            Facility* newFacility = new Facility(chosenType, settlement.getName());
-
-            // Use addFacility method
-            addFacility(newFacility);
+        while (constructionTypes.size() < maxConstruction) {
+            // Select a facility according to the selection policy and add it to the store
+            addFacility(selectionPolicy->selectFacility(facilityOptions), facilityOptions);
         }
     }
-    // Stage 3: Process facilities under construction
-    for (int i = static_cast<int>(underConstruction.size()) - 1; i >= 0; i--) {
-        Facility *facility = underConstruction[i];
 
-        // Update the facility's construction progress
-        FacilityStatus facilityStatus = facility->step();
+    // Stage 3: Advance the plan's clock and complete the facilities due on this step.
+    // Only plans with a facility due on this step look at their store, the rest compare a single cached tick.
+    clock++;
+    if (!constructionDue.empty() && nextDue == clock) {
+        completeDueFacilities(facilityOptions);
+    }
+
+    // Stage 4: Update the plan's status based on the number of facilities under construction
+    status = (constructionTypes.size() >= static_cast<size_t>(settlement.getType()) + 1) ? 
+             PlanStatus::BUSY : 
+             PlanStatus::AVALIABLE;
+}
 
-        // If the facility is now operational, move it to the facilities list
-        if (facilityStatus == FacilityStatus::OPERATIONAL) {
-            facilities.push_back(facility); // Add to the list of operational facilities
-            underConstruction.erase(underConstruction.begin() + i); // Remove from underConstruction
+void Plan::completeDueFacilities(const vector<FacilityType> &facilityOptions) {
+    // Facilities due on the same step become operational in reverse selection order, like the original reverse scan
+    for (size_t i = constructionDue.size(); i-- > 0;) {
+        if (constructionDue[i] == clock) {
+            const FacilityType &type = facilityOptions[constructionTypes[i]];
+            facilityTypes.push_back(constructionTypes[i]);
 
             // Update the scores based on the facility's attributes
-            life_quality_score += facility->getLifeQualityScore();
-            economy_score += facility->getEconomyScore();
-            environment_score += facility->getEnvironmentScore();
+            life_quality_score += type.getLifeQualityScore();
+            economy_score += type.getEconomyScore();
+            environment_score += type.getEnvironmentScore();
         }
     }
 
-    // Stage 4: Update the plan's status based on the number of facilities under construction
-    status = (underConstruction.size() >= static_cast<size_t>(settlement.getType()) + 1) ? 
-             PlanStatus::BUSY : 
-             PlanStatus::AVALIABLE;
+    // Compact both columns in one pass, keeping the selection order of the remaining facilities,
+    // and recompute the earliest due tick on the way
+    size_t kept = 0;
+    for (size_t i = 0; i < constructionDue.size(); i++) {
+        if (constructionDue[i] != clock) {
+            constructionTypes[kept] = constructionTypes[i];
+            constructionDue[kept] = constructionDue[i];
+            nextDue = (kept == 0) ? constructionDue[i] : std::min(nextDue, constructionDue[i]);
+            kept++;
+        }
+    }
+    constructionTypes.resize(kept);
+    constructionDue.resize(kept);
+}
+
+int Plan::ticksUntilEvent() const {
+    // An available plan selects new facilities on its very next step
+    if (status == PlanStatus::AVALIABLE || constructionDue.empty()) {
+        return 1;
+    }
+
+    // A busy plan only counts down until its first facility becomes operational
+    return nextDue - clock;
 }
 
-void Plan::addFacility(Facility *facility) {
-    // Add the newly created facility to the underConstruction list
-    underConstruction.push_back(facility);
+void Plan::skip(int ticks) {
+    clock += ticks;
 }
 
-void Plan::printStatus() {
+void Plan::addFacility(const FacilityType &facilityType, const vector<FacilityType> &facilityOptions) {
+    // The store keeps the index of the type in facilityOptions
+    if (&facilityType < facilityOptions.data() || &facilityType >= facilityOptions.data() + facilityOptions.size()) {
+        throw std::invalid_argument("Facility type is not one of the plan's facility options");
+    }
+    int typeId = static_cast<int>(&facilityType - facilityOptions.data());
+
+    // The countdown starts on the next step. A facility with no cost still needs that step to become operational.
+    int dueTick = clock + std::max(facilityType.getCost(), 1);
+
+    constructionTypes.push_back(typeId);
+    constructionDue.push_back(dueTick);
+    nextDue = (constructionDue.size() == 1) ? dueTick : std::min(nextDue, dueTick);
+}
+
+Facility Plan::buildFacility(const vector<FacilityType> &facilityOptions, int typeId, int dueTick) const {
+    Facility facility(facilityOptions[typeId], settlement.getName());
+
+    // A new facility starts with timeLeft = cost, count it down to the time left on the plan's clock
+    int timeLeft = std::min(facility.getTimeLeft(), dueTick - clock);
+    facility.advance(facility.getTimeLeft() - timeLeft);
+    return facility;
+}
+
+void Plan::printStatus(const vector<FacilityType> &facilityOptions) const {
     // Print the plan ID
     std::cout << "PlanID: " << plan_id << "\n";
 
@@ -228,20 +265,20 @@ void Plan::printStatus() {
     std::cout << "EconomyScore: " << economy_score << "\n";
     std::cout << "EnvironmentScore: " << environment_score << "\n";
 
-    // Print facilities under construction
-    for (const Facility* facility : underConstruction) {
-        std::cout << "FacilityName: " << facility->getName() << "\n";
+    // Print facilities under construction, only their names are needed so no Facility is built
+    for (int typeId : constructionTypes) {
+        std::cout << "FacilityName: " << facilityOptions[typeId].getName() << "\n";
         std::cout << "FacilityStatus: UNDER_CONSTRUCTION\n";
     }
 
     // Print operational facilities
-    for (const Facility* facility : facilities) {
-        std::cout << "FacilityName: " << facility->getName() << "\n";
+    for (int typeId : facilityTypes) {
+        std::cout << "FacilityName: " << facilityOptions[typeId].getName() << "\n";
         std::cout << "FacilityStatus: OPERATIONAL\n";
     }
 }
 
-const string Plan::toString() const {
+const string Plan::toString(const vector<FacilityType> &facilityOptions) const {
     std::ostringstream output;
 
     // Basic plan details
@@ -256,19 +293,15 @@ const string Plan::toString() const {
     }
 
     // Facilities under construction
-    output << "Facilities Under Construction (" << underConstruction.size() << "):\n";
-    for (const Facility* facility : underConstruction) {
-        if (facility) {
-            output << "  - " << facility->toString() << "\n";
-        }
+    output << "Facilities Under Construction (" << constructionTypes.size() << "):\n";
+    for (const Facility &facility : getFacilitiesUnderConstruction(facilityOptions)) {
+        output << "  - " << facility.toString() << "\n";
     }
 
     // Operational facilities
-    output << "Operational Facilities (" << facilities.size() << "):\n";
-    for (const Facility* facility : facilities) {
-        if (facility) {
-            output << "  - " << facility->toString() << "\n";
-        }
+    output << "Operational Facilities (" << facilityTypes.size() << "):\n";
+    for (const Facility &facility : getFacilities(facilityOptions)) {
+        output << "  - " << facility.toString() << "\n";
     }
 
     // Scores
@@ -277,4 +310,59 @@ const string Plan::toString() const {
     output << "Environment Score: " << environment_score << "\n";
 
     return output.str();
-}
\ No newline at end of file
+}
+
+void Plan::save(SnapshotWriter &out) const {
+    out.writeI32(plan_id);
+    selectionPolicy->save(out);
+    out.writeU8(static_cast<uint8_t>(status));
+    out.writeI32(life_quality_score);
+    out.writeI32(economy_score);
+    out.writeI32(environment_score);
+    out.writeI32(clock);
+
+    // The packed store is written as is
+    out.writeInts(facilityTypes);
+    out.writeInts(constructionTypes);
+    out.writeInts(constructionDue);
+}
+
+Plan Plan::load(SnapshotReader &in, const Settlement &settlement, const vector<FacilityType> &facilityOptions) {
+    int planId = in.readI32();
+    Plan plan(planId, settlement, loadPolicy(in));
+
+    uint8_t status = in.readU8();
+    if (status > static_cast<uint8_t>(PlanStatus::BUSY)) {
+        in.corrupt("invalid plan status");
+    }
+    plan.status = static_cast<PlanStatus>(status);
+    plan.life_quality_score = in.readI32();
+    plan.economy_score = in.readI32();
+    plan.environment_score = in.readI32();
+    plan.clock = in.readI32();
+    plan.facilityTypes = in.readInts();
+    plan.constructionTypes = in.readInts();
+    plan.constructionDue = in.readInts();
+
+    // Fixup pass: every index must name a catalog entry and every facility under construction must still be due,
+    // then the cached earliest due tick is rebuilt
+    if (plan.constructionDue.size() != plan.constructionTypes.size()) {
+        in.corrupt("plan construction columns differ in length");
+    }
+    for (int typeId : plan.facilityTypes) {
+        if (typeId < 0 || static_cast<size_t>(typeId) >= facilityOptions.size()) {
+            in.corrupt("plan facility is not in the catalog");
+        }
+    }
+    for (size_t i = 0; i < plan.constructionTypes.size(); i++) {
+        int typeId = plan.constructionTypes[i];
+        if (typeId < 0 || static_cast<size_t>(typeId) >= facilityOptions.size()) {
+            in.corrupt("plan facility is not in the catalog");
+        }
+        if (plan.constructionDue[i] <= plan.clock) {
+            in.corrupt("plan facility under construction is overdue");
+        }
+        plan.nextDue = (i == 0) ? plan.constructionDue[i] : std::min(plan.nextDue, plan.constructionDue[i]);
+    }
+    return plan;
+}
@@ -27,6 +27,17 @@ NaiveSelection* NaiveSelection::clone() const {
     return new NaiveSelection(*this);
 }
 
+void NaiveSelection::save(SnapshotWriter &out) const {
+    out.writeString(toString());
+    out.writeI32(lastSelectedIndex);
+}
+
+NaiveSelection *NaiveSelection::load(SnapshotReader &in) {
+    NaiveSelection *policy = new NaiveSelection();
+    policy->lastSelectedIndex = in.readI32();
+    return policy;
+}
+
 //-----------BalancedSelection implementation-----------
 BalancedSelection::BalancedSelection(int lifeQuality, int economy, int environment)
     : LifeQualityScore(lifeQuality), EconomyScore(economy), EnvironmentScore(environment) {}
@@ -87,6 +98,20 @@ BalancedSelection* BalancedSelection::clone() const {
     return new BalancedSelection(*this);
 }
 
+void BalancedSelection::save(SnapshotWriter &out) const {
+    out.writeString(toString());
+    out.writeI32(LifeQualityScore);
+    out.writeI32(EconomyScore);
+    out.writeI32(EnvironmentScore);
+}
+
+BalancedSelection *BalancedSelection::load(SnapshotReader &in) {
+    int lifeQuality = in.readI32();
+    int economy = in.readI32();
+    int environment = in.readI32();
+    return new BalancedSelection(lifeQuality, economy, environment);
+}
+
 // Setter methods to update scores
 void BalancedSelection::setLifeQualityScore(int score) { LifeQualityScore = score; }
 void BalancedSelection::setEconomyScore(int score) { EconomyScore = score; }
@@ -120,6 +145,17 @@ EconomySelection* EconomySelection::clone() const {
     return new EconomySelection(*this);
 }
 
+void EconomySelection::save(SnapshotWriter &out) const {
+    out.writeString(toString());
+    out.writeI32(lastSelectedIndex);
+}
+
+EconomySelection *EconomySelection::load(SnapshotReader &in) {
+    EconomySelection *policy = new EconomySelection();
+    policy->lastSelectedIndex = in.readI32();
+    return policy;
+}
+
 
 //-----------SustainabilitySelection implementation-----------
 SustainabilitySelection::SustainabilitySelection() : lastSelectedIndex(-1) {}
@@ -148,6 +184,17 @@ SustainabilitySelection* SustainabilitySelection::clone() const {
     return new SustainabilitySelection(*this);
 }
 
+void SustainabilitySelection::save(SnapshotWriter &out) const {
+    out.writeString(toString());
+    out.writeI32(lastSelectedIndex);
+}
+
+SustainabilitySelection *SustainabilitySelection::load(SnapshotReader &in) {
+    SustainabilitySelection *policy = new SustainabilitySelection();
+    policy->lastSelectedIndex = in.readI32();
+    return policy;
+}
+
 
 
 //Helper function to convert string to policy
@@ -164,3 +211,18 @@ SelectionPolicy* createPolicy(const std::string &policyName) {
         throw std::invalid_argument("Invalid selection policy: " + policyName);
     }
 }
+
+SelectionPolicy* loadPolicy(SnapshotReader &in) {
+    // The policy's name tells which state follows
+    std::string policyName = in.readString();
+    if (policyName == "nve") {
+        return NaiveSelection::load(in);
+    } else if (policyName == "bal") {
+        return BalancedSelection::load(in);
+    } else if (policyName == "eco") {
+        return EconomySelection::load(in);
+    } else if (policyName == "env") {
+        return SustainabilitySelection::load(in);
+    }
+    in.corrupt("unknown selection policy " + policyName);
+}
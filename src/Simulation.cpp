@@ -1,210 +1,234 @@
 #include "Simulation.h"
-#include "Auxiliary.h"
 #include "Action.h"
-#include <fstream>        // For file input/output operations ( reading the configuration file).
+#include "ConfigLoader.h"
+#include "BatchIO.h"
+#include "Journal.h"
 #include <sstream>        // For tokenizing user input using istringstream.
 #include <stdexcept>      // For throwing and handling runtime errors.
 #include <iostream>       // For console I/O operations (logging messages with cout).
+#include <thread>         // For std::thread::hardware_concurrency.
+#include <chrono>         // For timing batch runs.
+#include <unistd.h>       // For STDOUT_FILENO and STDERR_FILENO.
 
 // ---------- Simulation Implementation ----------
 
-Simulation::Simulation(const string &configFilePath)
+Simulation::Simulation(const string &configFilePath, int numThreads)
     : isRunning(false),    // Simulation starts as running
       planCounter(0),     // Initialize plan counter
+      arena(std::make_shared<Arena>()), // Empty arena, blocks are reserved on first use
       actionsLog(),       // Empty action log
       plans(),            // Empty plans list
       settlements(),      // Empty settlements list
-      facilitiesOptions() // Empty facility options list
+      facilitiesOptions(std::make_shared<vector<FacilityType>>()), // Empty facility options list
+      settlementIndex(std::make_shared<std::unordered_multimap<string, size_t>>()), // Empty name indices
+      facilityIndex(std::make_shared<std::unordered_multimap<string, size_t>>()),
+      numThreads(1),      // Serial stepping unless configured otherwise
+      threadPool(nullptr), // Workers are only started by the first parallel step
+      journal(nullptr)
 {
-    // Open the configuration file
-    std::ifstream configFile(configFilePath);
-    if (!configFile.is_open())
-    {
-        throw std::runtime_error("Failed to open configuration file."); // Ensure the file is accessible
-    }
+    // Map the configuration file, this throws if it cannot be opened
+    ConfigLoader loader(configFilePath);
 
-    std::string line;
-    while (std::getline(configFile, line))
-    {
-        // Ignore comments (lines starting with '#') and blank lines
-        if (line.empty() || line[0] == '#')
-        {
-            continue;
+    // Large files are parsed on worker threads. The pool is kept for stepping if the thread count matches.
+    int loaderThreads = (numThreads > 0) ? numThreads : static_cast<int>(std::thread::hardware_concurrency());
+    if (loaderThreads > 1 && loader.getSize() >= ConfigLoader::PARALLEL_THRESHOLD) {
+        threadPool = new ThreadPool(loaderThreads);
+    }
+    loader.parse(threadPool);
+
+    // Apply the entries in file order. Parsing stopped at the first malformed line of each chunk,
+    // so nothing after a failed chunk is applied and its malformed line is reported last.
+    // Plans are only collected here, with the number of settlements defined before their line.
+    struct PendingPlan {
+        const ConfigEntry *entry;
+        size_t line;
+        size_t settlementsBefore;
+        Settlement *settlement;
+    };
+    vector<PendingPlan> pendingPlans;
+    const ConfigChunk *failedChunk = nullptr;
+    for (const ConfigChunk &chunk : loader.getChunks()) {
+        for (const ConfigEntry &entry : chunk.entries) {
+            switch (entry.type) {
+                case ConfigEntryType::SETTLEMENT: {
+                    // Allocate the settlement in the arena. The first settlement with a name wins lookups.
+                    Settlement *settlement = arena->create<Settlement>(entry.name.str(), createSettlementType(entry.values[0]));
+                    settlementIndex->emplace(settlement->getName(), settlements.size());
+                    settlements.push_back(settlement);
+                    break;
+                }
+                case ConfigEntryType::FACILITY: {
+                    // Create and add the facility to the list of options
+                    FacilityType facility(entry.name.str(), createFacilityCategory(entry.values[0]), entry.values[1],
+                                          entry.values[2], entry.values[3], entry.values[4]);
+                    facilityIndex->emplace(facility.getName(), facilitiesOptions->size());
+                    facilitiesOptions->push_back(facility);
+                    break;
+                }
+                case ConfigEntryType::PLAN: {
+                    PendingPlan plan = {&entry, chunk.firstLine + entry.line, settlements.size(), nullptr};
+                    pendingPlans.push_back(plan);
+                    break;
+                }
+                case ConfigEntryType::THREADS:
+                    this->numThreads = entry.values[0];
+                    break;
+            }
         }
-
-        // Tokenize the line into arguments
-        std::vector<std::string> args = Auxiliary::parseArguments(line);
-        if (args.empty())
-        {
-            continue; // Skip invalid or empty lines
+        if (chunk.failed) {
+            failedChunk = &chunk;
+            break;
         }
+    }
 
-        // Handle configuration based on the first token (entry type)
-        if (args[0] == "settlement")
-        {
-            // Validate the format for settlements
-            if (args.size() != 3)
-            {
-                throw std::runtime_error("Invalid settlement format in config file.");
-            }
-            std::string settlementName = args[1];
-            SettlementType type = createSettlementType(std::stoi(args[2])); // Convert type from integer
-            Settlement *settlement = new Settlement(settlementName, type);  // Allocate settlement dynamically
-            settlements.push_back(settlement);                              // Add to the settlements vector
+    // The settlements are all known now, so the name lookups of the plans are independent of each other
+    // and run on the workers. A plan only sees the settlements defined above it.
+    auto resolvePlans = [this, &pendingPlans](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            PendingPlan &plan = pendingPlans[i];
+            plan.settlement = findSettlement(plan.entry->name.str(), plan.settlementsBefore);
         }
+    };
+    if (threadPool != nullptr) {
+        threadPool->parallelFor(pendingPlans.size(), resolvePlans);
+    } else {
+        resolvePlans(0, pendingPlans.size());
+    }
 
-        else if (args[0] == "facility")
+    for (const PendingPlan &plan : pendingPlans) {
+        if (plan.settlement == nullptr)
         {
-            // Validate the format for facilities
-            if (args.size() != 7)
-            {
-                throw std::runtime_error("Invalid facility format in config file.");
-            }
-            std::string facilityName = args[1];
-            FacilityCategory category = createFacilityCategory(std::stoi(args[2])); // Convert category from integer
-            int price = std::stoi(args[3]);
-            int lifeQualityImpact = std::stoi(args[4]);
-            int economyImpact = std::stoi(args[5]);
-            int environmentImpact = std::stoi(args[6]);
-
-            // Create and add the facility to the list of options
-            FacilityType facility(facilityName, category, price, lifeQualityImpact, economyImpact, environmentImpact);
-            facilitiesOptions.push_back(facility);
+            throw std::runtime_error("Line " + std::to_string(plan.line) + ": Settlement not found for plan: " + plan.entry->name.str());
         }
 
-        else if (args[0] == "plan")
-        {
-            // Validate the format for plans
-            if (args.size() != 3)
-            {
-                throw std::runtime_error("Invalid plan format in config file.");
-            }
-            std::string settlementName = args[1];
-            std::string selectionPolicy = args[2];
-
-            SelectionPolicy *policy = createPolicy(selectionPolicy); // Dynamically allocate the selection policy
-
-            Settlement *p = settlements[0]; // Default to the first settlement (to avoid null pointer)
-            for (size_t i = 0; i < settlements.size(); i++)
-            {
-                if (settlements[i]->getName() == settlementName)
-                {
-                    p = settlements[i]; // Match the settlement name
-                    break;
-                }
-                else if (i == settlements.size() - 1)
-                {
-                    throw std::runtime_error("Settlement not found for plan: " + settlementName);
-                }
-            }
+        // Create a new plan associated with the matched settlement
+        plans.push_back(Plan(planCounter++, *plan.settlement, createPolicy(plan.entry->policy.str())));
+    }
+    if (failedChunk != nullptr) {
+        throw std::runtime_error("Line " + std::to_string(failedChunk->errorLine) + ": " + failedChunk->errorMessage);
+    }
 
-            // Create a new plan associated with the matched settlement
-            Plan plan(planCounter++, *p, policy, facilitiesOptions);
-            plans.push_back(plan);
-        }
-        else
-        {
-            throw std::runtime_error("Unknown configuration entry type: " + args[0]); // Handle unknown entries
-        }
+    // The caller's thread count overrides the config file
+    if (numThreads > 0) {
+        this->numThreads = numThreads;
     }
 
-    configFile.close(); // Ensure the file is closed after processing
+    // Only keep the loader's workers if stepping is going to use the same number of threads
+    if (threadPool != nullptr && threadPool->size() != this->numThreads) {
+        delete threadPool;
+        threadPool = nullptr;
+    }
 }
 
-// Copy Constructor
-Simulation::Simulation(const Simulation &other)
-    : isRunning(other.isRunning), 
-      planCounter(other.planCounter), 
-      actionsLog(), 
-      plans(), 
-      settlements(), 
-      facilitiesOptions() 
+// Snapshot constructor: reads the fields of one image straight from the mapped file, then resolves the
+// positions it stores (the settlement of each plan, the catalog entries of each facility) in a fixup pass
+Simulation::Simulation(SnapshotReader &in)
+    : isRunning(false),
+      planCounter(0),
+      arena(std::make_shared<Arena>()),
+      actionsLog(),
+      plans(),
+      settlements(),
+      facilitiesOptions(std::make_shared<vector<FacilityType>>()),
+      settlementIndex(std::make_shared<std::unordered_multimap<string, size_t>>()),
+      facilityIndex(std::make_shared<std::unordered_multimap<string, size_t>>()),
+      numThreads(1),
+      threadPool(nullptr),
+      journal(nullptr)
 {
-    // Deep copy of actionsLog: Clone each BaseAction to ensure unique ownership.
-    for (BaseAction* action : other.actionsLog) {
-        actionsLog.push_back(action->clone());
+    size_t imageEnd = in.beginSection();
+    isRunning = in.readU8() != 0;
+    planCounter = in.readI32();
+    numThreads = in.readI32();
+    if (numThreads < 1) {
+        in.corrupt("invalid thread count");
     }
 
-    // Deep copy of settlements: Dynamically allocate and copy each Settlement.
-    for (Settlement* settlement : other.settlements) {
-        settlements.push_back(new Settlement(*settlement));
+    uint32_t settlementCount = in.readU32();
+    for (uint32_t i = 0; i < settlementCount; i++) {
+        string name = in.readString();
+        uint8_t type = in.readU8();
+        if (type > static_cast<uint8_t>(SettlementType::METROPOLIS)) {
+            in.corrupt("invalid settlement type");
+        }
+        settlementIndex->emplace(name, settlements.size());
+        settlements.push_back(arena->create<Settlement>(name, static_cast<SettlementType>(type)));
     }
 
-    // Deep copy of plans:
-    // Each Plan references a Settlement. When copying, the Settlement pointers must be updated to point to the newly created copies in `settlements`.
-    for (Plan plan : other.plans) {
-        // Retrieve the name of the Settlement associated with the plan.
-        std::string name = plan.getSettlement().getName();
-        // Find the corresponding Settlement in the copied settlements vector.
-        Settlement* s = &getSettlement(name); 
-        // Create a new Plan using the copy constructor with settlement.
-        plans.push_back(Plan(plan, *s)); 
+    uint32_t facilityCount = in.readU32();
+    for (uint32_t i = 0; i < facilityCount; i++) {
+        string name = in.readString();
+        uint8_t category = in.readU8();
+        if (category > static_cast<uint8_t>(FacilityCategory::ENVIRONMENT)) {
+            in.corrupt("invalid facility category");
+        }
+        int price = in.readI32();
+        int lifeQualityImpact = in.readI32();
+        int economyImpact = in.readI32();
+        int environmentImpact = in.readI32();
+        facilityIndex->emplace(name, facilitiesOptions->size());
+        facilitiesOptions->push_back(FacilityType(name, static_cast<FacilityCategory>(category), price,
+                                                  lifeQualityImpact, economyImpact, environmentImpact));
     }
 
-    // Copy of facilitiesOptions: Since FacilityType has no dynamic members, use its copy constructor.
-    for (FacilityType facility : other.facilitiesOptions) {
-        facilitiesOptions.push_back(FacilityType(facility));
+    uint32_t planCount = in.readU32();
+    if (planCount != static_cast<uint32_t>(planCounter)) {
+        in.corrupt("plan count does not match the plan counter");
     }
+    for (uint32_t i = 0; i < planCount; i++) {
+        uint32_t settlementPosition = in.readU32();
+        if (settlementPosition >= settlements.size()) {
+            in.corrupt("plan settlement out of range");
+        }
+        Plan plan = Plan::load(in, *settlements[settlementPosition], *facilitiesOptions);
+        if (plan.getID() != static_cast<int>(i)) {
+            in.corrupt("plan IDs are not dense");
+        }
+        plans.push_back(std::move(plan));
+    }
+
+    actionsLog = ActionLog(in);
+    in.endSection(imageEnd);
 }
 
-// Copy Assignment Operator
+// Copy Constructor: shares the whole state with `other`, nothing is copied until one of them modifies it
+Simulation::Simulation(const Simulation &other)
+    : isRunning(other.isRunning), 
+      planCounter(other.planCounter), 
+      arena(other.arena), // Settlements are never modified, so they are shared for good
+      actionsLog(other.actionsLog), 
+      plans(other.plans), 
+      settlements(other.settlements), 
+      facilitiesOptions(other.facilitiesOptions),
+      settlementIndex(other.settlementIndex),
+      facilityIndex(other.facilityIndex),
+      numThreads(other.numThreads),
+      threadPool(nullptr), // The copy starts its own workers if it ever steps in parallel
+      journal(nullptr) // Only the running simulation journals its commands
+{
+}
+
+// Copy Assignment Operator: drops our state and shares the one of `other`, in O(1)
 Simulation &Simulation::operator=(const Simulation &other) {
     // Check for self-assignment to avoid unnecessary work and potential issues.
     if (this == &other) {
         return *this;
     }
 
-    //----Clean the state of 'this'----
-
-    // Clear plans (no dynamic allocation in Plan, so just clear the vector).
-    plans.clear();
-
-    // Clear the facilitiesOptions vector (shallow clear as FacilityType doesn't use dynamic memory).
-    facilitiesOptions.clear();
-
-    // Free dynamically allocated actions and clear the actions log.
-    for (BaseAction* action : actionsLog) {
-        delete action;
-    }
-    actionsLog.clear();
-
-    // Free dynamically allocated settlements
-    for (Settlement* settlement : settlements) {
-        delete settlement;
-    }
-    settlements.clear(); 
-
-    //----Copy 'other' to 'this'----
-
     // Copy primitive and value-based members.
     isRunning = other.isRunning;
     planCounter = other.planCounter;
-
-    // Deep copy actionsLog
-    for (BaseAction* action : other.actionsLog) {
-        actionsLog.push_back(action->clone()); // Clone each action in the log.
-    }
-
-    // Deep copy of settlements: Dynamically allocate and copy each Settlement.
-    for (Settlement* settlement : other.settlements) {
-        settlements.push_back(new Settlement(*settlement));
-    }
-
-    // Deep copy of plans:
-    // Each Plan references a Settlement. When copying, the Settlement pointers must be updated to point to the newly created copies in `settlements`.
-    for (Plan plan : other.plans) {
-        // Retrieve the name of the Settlement associated with the plan.
-        std::string name = plan.getSettlement().getName();
-        // Find the corresponding Settlement in the copied settlements vector.
-        Settlement* s = &getSettlement(name); 
-        // Create a new Plan using the copy constructor with settlement.
-        plans.push_back(Plan(plan, *s)); 
-    }
-
-    // Deep copy facilitiesOptions
-    for (FacilityType facility : other.facilitiesOptions) {
-        facilitiesOptions.push_back(FacilityType(facility)); // Copy FacilityType objects.
-    }
+    numThreads = other.numThreads; // The pool itself is kept, getThreadPool() resizes it if needed
+    // The journal is kept too, a restored or loaded simulation goes on journaling
+
+    // Share the state of `other`. Whatever we held is released once no other copy refers to it.
+    plans = other.plans;
+    actionsLog = other.actionsLog;
+    settlements = other.settlements;
+    facilitiesOptions = other.facilitiesOptions;
+    settlementIndex = other.settlementIndex;
+    facilityIndex = other.facilityIndex;
+    arena = other.arena;
 
     return *this;
 }
@@ -214,12 +238,22 @@ Simulation::Simulation(Simulation &&other)
     : isRunning(other.isRunning),
       planCounter(other.planCounter),
       // Use std::move for efficient ownership transfer, avoiding deep copying.
+      arena(std::move(other.arena)), // Settlements keep their addresses
       actionsLog(std::move(other.actionsLog)),   
       plans(std::move(other.plans)),             
       settlements(std::move(other.settlements)),
-      facilitiesOptions(std::move(other.facilitiesOptions))
+      facilitiesOptions(std::move(other.facilitiesOptions)),
+      // The indices name positions in settlements and facilitiesOptions, both survive the move
+      settlementIndex(std::move(other.settlementIndex)),
+      facilityIndex(std::move(other.facilityIndex)),
+      numThreads(other.numThreads),
+      threadPool(other.threadPool), // Take ownership of the running workers
+      journal(other.journal)
 {
-      // After std::move, the vectors in 'other' are in a valid but unspecified state.
+      other.threadPool = nullptr; // Prevent the workers from being joined twice
+      other.journal = nullptr;
+
+      // After std::move, the members of 'other' are in a valid but unspecified state.
       // This is sufficient for the move constructor, as the destructor of 'other' will handle cleanup.
 }
 
@@ -230,44 +264,29 @@ Simulation &Simulation::operator=(Simulation &&other) {
         return *this;
     }
 
-    //----Clean the state of 'this'----
-
-    // Clear plans and facilitiesOptions. No dynamic memory to free here.
-    plans.clear();
-    facilitiesOptions.clear();
-
-    // Free dynamically allocated actions in `this->actionsLog`.
-    for (BaseAction* action : actionsLog) {
-        delete action;
-    }
-    actionsLog.clear();
-
-    // Free dynamically allocated settlements
-    for (Settlement* settlement : settlements) {
-        delete settlement;
-    }
-    settlements.clear(); 
-
-    //----Move 'other' to 'this'----
-
     // Copy primitive and value-based members from `other`.
     isRunning = other.isRunning;
     planCounter = other.planCounter;
+    numThreads = other.numThreads;
 
-    // Move other resources into `this` to transfer ownership.
-    settlements = std::move(other.settlements);
-    actionsLog = std::move(other.actionsLog);
+    // Take over the workers of `other`, releasing our own
+    delete threadPool;
+    threadPool = other.threadPool;
+    other.threadPool = nullptr;
+
+    // Take over the state of `other`, releasing our own unless a copy still shares it.
     plans = std::move(other.plans);
+    actionsLog = std::move(other.actionsLog);
+    settlements = std::move(other.settlements);
     facilitiesOptions = std::move(other.facilitiesOptions);
+    settlementIndex = std::move(other.settlementIndex);
+    facilityIndex = std::move(other.facilityIndex);
+    arena = std::move(other.arena);
 
     // Leave `other` in a valid empty state to ensure safe destruction.
     // This makes it clear that `other` is no longer usable after the move.
-    other.settlements.clear();
-    other.actionsLog.clear();
-    other.plans.clear();
-    other.facilitiesOptions.clear();
+    other.resetState();
     other.isRunning = false;
-    other.planCounter = 0;
 
     return *this;
 }
@@ -275,23 +294,16 @@ Simulation &Simulation::operator=(Simulation &&other) {
 // Destructor
 Simulation::~Simulation() {
 
-    // Free dynamically allocated actions
-    for (BaseAction* action : actionsLog) {
-        delete action;
-    }
-    actionsLog.clear(); // Ensures a clean state before destruction, though not strictly necessary.
-
-    // Free dynamically allocated settlements
-    for (Settlement* settlement : settlements) {
-        delete settlement;
-    }
-    settlements.clear(); // Ensures a clean state before destruction, though not strictly necessary.
-
-    // Clear plans (no dynamic allocation, just reset the vector)
-    plans.clear(); // Optional but ensures explicit reset of the vector.
+    // Release our share of the state, plans first since they refer to the settlements.
+    // Everything not shared with a copy goes away here, the settlements with the arena's blocks.
+    plans.clear();
+    actionsLog.clear();
+    settlements.clear();
+    arena.reset();
 
-    // Clear facilities (no dynamic memory, just reset the vector)
-    facilitiesOptions.clear(); // Keeps the state consistent, though not strictly required.
+    // Stop and join the worker threads
+    delete threadPool;
+    threadPool = nullptr;
 }
 
 
@@ -303,175 +315,479 @@ void Simulation::start() {
 
     while (isRunning) {
         try {
+            // Everything accepted so far is on disk before we wait for the next command
+            if (journal != nullptr) {
+                journal->commit();
+            }
             std::cout << "> "; // Prompt the user
             std::string input;
             std::getline(std::cin, input); // Read the full user input as a single line
+            runCommand(input);
+        } catch (const std::exception &e) {
+            // Print the error message and continue the loop
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
+}
 
-            std::istringstream iss(input); // Parse the input into tokens
-            std::string command;
-            iss >> command; // Extract the first token as the command
-
-            if (command == "step") {
-                int numOfSteps;
-                iss >> numOfSteps; // Attempt to extract the number of steps
-                if (iss.fail() || numOfSteps <= 0) {
-                    throw std::runtime_error("Invalid input for step");
-                }
-                SimulateStep action(numOfSteps); // Create an action for simulating steps
-                action.act(*this);
-            } else if (command == "plan") {
-                std::string settlementName, selectionPolicy;
-                iss >> settlementName >> selectionPolicy; // Extract settlement and policy
-                if (settlementName.empty() || selectionPolicy.empty()) {
-                    throw std::runtime_error("Invalid input for plan");
-                }
-                AddPlan action(settlementName, selectionPolicy); // Add a plan
-                action.act(*this);
-            } else if (command == "settlement") {
-                std::string settlementName;
-                int settlementTypeInt;
-                iss >> settlementName >> settlementTypeInt; // Extract settlement name and type as an int
-                if (settlementName.empty() || iss.fail() || settlementTypeInt < 0 || settlementTypeInt > 2) {
-                    throw std::runtime_error("Invalid input for settlement");
-                }
+void Simulation::startBatch(LineReader &input) {
+    // Log the start of the simulation
+    std::cout << "The simulation has started" << std::endl;
 
-                // Convert integer to SettlementType using static_cast
-                SettlementType settlementType = static_cast<SettlementType>(settlementTypeInt);
-
-                AddSettlement action(settlementName, settlementType); // Add a settlement
-                action.act(*this);
-            } else if (command == "facility") {
-                std::string facilityName;
-                int category, price, lifeQ, economy, environment;
-                iss >> facilityName >> category >> price >> lifeQ >> economy >> environment; // Extract facility details
-                if (facilityName.empty() || iss.fail() || category < 0 || category > 2 || price < 0 || lifeQ < 0 || economy < 0 || environment < 0) {
-                    throw std::runtime_error("Invalid input for facility");
-                }
+    // Swap large buffers into the standard streams for the whole batch, std::endl no longer writes anything
+    BufferedOutput output(STDOUT_FILENO);
+    BufferedOutput errors(STDERR_FILENO);
+    std::streambuf *coutBuffer = std::cout.rdbuf(&output);
+    std::streambuf *cerrBuffer = std::cerr.rdbuf(&errors);
 
-                // Convert integer to FacilityCategory using static_cast
-                FacilityCategory facilityCategory = static_cast<FacilityCategory>(category);
+    isRunning = true;
+    size_t commands = 0;
+    auto begin = std::chrono::steady_clock::now();
+    std::string line;
+    // The batch ends at a close command or at the end of the input
+    while (isRunning && input.nextLine(line)) {
+        commands++;
+        try {
+            runCommand(line);
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
 
-                AddFacility action(facilityName, facilityCategory, price, lifeQ, economy, environment); // Add a facility
-                action.act(*this);
-            } else if (command == "planStatus") {
-                int planId;
-                iss >> planId; // Extract plan ID
-                if (iss.fail()) {
-                    throw std::runtime_error("Invalid input for planStatus");
-                }
-                PrintPlanStatus action(planId); // Print the status of a specific plan
-                action.act(*this);
-            } else if (command == "changePolicy") {
-                int planId;
-                std::string newPolicy;
-                iss >> planId >> newPolicy; // Extract plan ID and new policy
-                if (iss.fail() || newPolicy.empty()) {
-                    throw std::runtime_error("Invalid input for changePolicy");
-                }
-                ChangePlanPolicy action(planId, newPolicy); // Change the policy of a specific plan
-                action.act(*this);
-            } else if (command == "log") {
-                PrintActionsLog action; // Log all actions taken
-                action.act(*this);
-            } else if (command == "backup") {
-                BackupSimulation action; // Backup the current simulation state
-                action.act(*this);
-            } else if (command == "restore") {
-                RestoreSimulation action; // Restore the simulation from backup
-                action.act(*this);
-            } else if (command == "close") {
-                Close action; // Close the simulation
-                action.act(*this);
-            } else {
-                throw std::runtime_error("Unknown command"); // Handle invalid commands
-            }
+    if (journal != nullptr) {
+        try {
+            journal->commit();
         } catch (const std::exception &e) {
-            // Print the error message and continue the loop
             std::cerr << "Error: " << e.what() << std::endl;
         }
     }
+    output.flush();
+    errors.flush();
+    std::cout.rdbuf(coutBuffer);
+    std::cerr.rdbuf(cerrBuffer);
+
+    // Reported on stderr, so the output of a batch matches the output of the same commands typed in
+    std::cerr << "Batch: " << commands << " commands in " << seconds << " s ("
+              << static_cast<long long>(seconds > 0 ? commands / seconds : 0) << " commands/s)" << std::endl;
+}
+
+size_t Simulation::replay(LineReader &input, size_t &validBytes) {
+    // Nothing is printed: a stream without a buffer fails every write right away, before formatting anything
+    std::streambuf *coutBuffer = std::cout.rdbuf(nullptr);
+    std::streambuf *cerrBuffer = std::cerr.rdbuf(nullptr);
+    // The commands are in the journal already
+    Journal *activeJournal = journal;
+    journal = nullptr;
+
+    size_t commands = 0;
+    validBytes = 0;
+    std::string line;
+    while (input.nextLine(line) && input.lastLineComplete()) {
+        commands++;
+        validBytes += line.size() + 1;
+        try {
+            runCommand(line);
+        } catch (const std::exception &) {
+            // Only accepted commands are journaled, so this only happens if a file changed since (e.g. `load`)
+        }
+    }
+
+    journal = activeJournal;
+    std::cout.rdbuf(coutBuffer); // Also clears the error state
+    std::cerr.rdbuf(cerrBuffer);
+    return commands;
+}
+
+void Simulation::runCommand(const string &input) {
+    std::istringstream iss(input); // Parse the input into tokens
+    std::string command;
+    iss >> command; // Extract the first token as the command
+
+    if (command == "step") {
+        int numOfSteps;
+        iss >> numOfSteps; // Attempt to extract the number of steps
+        if (iss.fail() || numOfSteps <= 0) {
+            throw std::runtime_error("Invalid input for step");
+        }
+        SimulateStep action(numOfSteps); // Create an action for simulating steps
+        action.act(*this);
+    } else if (command == "plan") {
+        std::string settlementName, selectionPolicy;
+        iss >> settlementName >> selectionPolicy; // Extract settlement and policy
+        if (settlementName.empty() || selectionPolicy.empty()) {
+            throw std::runtime_error("Invalid input for plan");
+        }
+        AddPlan action(settlementName, selectionPolicy); // Add a plan
+        action.act(*this);
+    } else if (command == "settlement") {
+        std::string settlementName;
+        int settlementTypeInt;
+        iss >> settlementName >> settlementTypeInt; // Extract settlement name and type as an int
+        if (settlementName.empty() || iss.fail() || settlementTypeInt < 0 || settlementTypeInt > 2) {
+            throw std::runtime_error("Invalid input for settlement");
+        }
+
+        // Convert integer to SettlementType using static_cast
+        SettlementType settlementType = static_cast<SettlementType>(settlementTypeInt);
+
+        AddSettlement action(settlementName, settlementType); // Add a settlement
+        action.act(*this);
+    } else if (command == "facility") {
+        std::string facilityName;
+        int category, price, lifeQ, economy, environment;
+        iss >> facilityName >> category >> price >> lifeQ >> economy >> environment; // Extract facility details
+        if (facilityName.empty() || iss.fail() || category < 0 || category > 2 || price < 0 || lifeQ < 0 || economy < 0 || environment < 0) {
+            throw std::runtime_error("Invalid input for facility");
+        }
+
+        // Convert integer to FacilityCategory using static_cast
+        FacilityCategory facilityCategory = static_cast<FacilityCategory>(category);
+
+        AddFacility action(facilityName, facilityCategory, price, lifeQ, economy, environment); // Add a facility
+        action.act(*this);
+    } else if (command == "planStatus") {
+        int planId;
+        iss >> planId; // Extract plan ID
+        if (iss.fail()) {
+            throw std::runtime_error("Invalid input for planStatus");
+        }
+        PrintPlanStatus action(planId); // Print the status of a specific plan
+        action.act(*this);
+    } else if (command == "changePolicy") {
+        int planId;
+        std::string newPolicy;
+        iss >> planId >> newPolicy; // Extract plan ID and new policy
+        if (iss.fail() || newPolicy.empty()) {
+            throw std::runtime_error("Invalid input for changePolicy");
+        }
+        ChangePlanPolicy action(planId, newPolicy); // Change the policy of a specific plan
+        action.act(*this);
+    } else if (command == "log") {
+        PrintActionsLog action; // Log all actions taken
+        action.act(*this);
+    } else if (command == "backup") {
+        BackupSimulation action; // Backup the current simulation state
+        action.act(*this);
+    } else if (command == "restore") {
+        RestoreSimulation action; // Restore the simulation from backup
+        action.act(*this);
+    } else if (command == "save") {
+        std::string path;
+        iss >> path; // Extract the snapshot path
+        if (path.empty()) {
+            throw std::runtime_error("Invalid input for save");
+        }
+        SaveSnapshot action(path); // Write the simulation to a snapshot file
+        action.act(*this);
+    } else if (command == "load") {
+        std::string path;
+        iss >> path; // Extract the snapshot path
+        if (path.empty()) {
+            throw std::runtime_error("Invalid input for load");
+        }
+        LoadSnapshot action(path); // Replace the simulation with a snapshot file
+        action.act(*this);
+    } else if (command == "flush") {
+        // Writes out the output buffered by the batch mode, interactive output is never held back
+        BufferedOutput::flush(std::cout);
+        BufferedOutput::flush(std::cerr);
+        if (journal != nullptr) {
+            journal->commit();
+        }
+        return; // Not an action, so not journaled
+    } else if (command == "close") {
+        Close action; // Close the simulation
+        action.act(*this);
+    } else {
+        throw std::runtime_error("Unknown command"); // Handle invalid commands
+    }
+
+    // The command reached its action, which logged it: journal it so that a replay logs it again
+    if (journal != nullptr) {
+        journal->append(input);
+    }
 }
 
 void Simulation::addPlan(const Settlement &settlement, SelectionPolicy *selectionPolicy) {
     // Create a new plan with a unique ID, using the provided settlement and selection policy
-    Plan newPlan(planCounter++, settlement, selectionPolicy, facilitiesOptions);
-    
-    plans.push_back(newPlan); 
+    plans.push_back(Plan(planCounter++, settlement, selectionPolicy));
 }
 
-void Simulation::addAction(BaseAction *action) {
-    // Add the provided action to the actions log
-    actionsLog.push_back(action);
+void Simulation::addAction(const BaseAction &action) {
+    // The action writes itself as a record, identical consecutive actions fold into one
+    action.appendTo(actionsLog);
 }
 
-bool Simulation::addSettlement(Settlement *settlement) {
+bool Simulation::addSettlement(const Settlement &settlement) {
     // Check if the settlement already exists
-    if (isSettlementExists(settlement->getName())) {
+    if (isSettlementExists(settlement.getName())) {
         return false; // Settlement already exists, return false
     }
-    // Add the new settlement to the vector
-    settlements.push_back(settlement);
+    // Copy the new settlement into the arena and add it to the vector and the index
+    settlementIndex->emplace(settlement.getName(), settlements.size());
+    settlements.push_back(arena->create<Settlement>(settlement));
     return true; // Successfully added the settlement
 }
 
 bool Simulation::addFacility(FacilityType facility) {
     // Check if a facility with the same name already exists
-    for (const auto &existingFacility : facilitiesOptions) {
-        if (existingFacility.getName() == facility.getName()) {
-            return false; // Facility already exists, return false
-        }
+    if (isFacilityExists(facility.getName())) {
+        return false; // Facility already exists, return false
     }
 
-    // Add the new facility type to the vector
-    facilitiesOptions.push_back(std::move(facility));
+    // Add the new facility type to the vector and the index
+    vector<FacilityType> &options = ownFacilitiesOptions();
+    facilityIndex->emplace(facility.getName(), options.size());
+    options.push_back(std::move(facility));
     return true; // Successfully added the facility
 }
 
 bool Simulation::isSettlementExists(const string &settlementName) {
-    // Search for a settlement with the given name
-    for (const auto &settlement : settlements) {
-        if (settlement->getName() == settlementName) {
-            return true; // Settlement exists
-        }
-    }
-    return false; // Settlement not found
+    // Hashed lookup by name
+    return findSettlement(settlementName) != nullptr;
 }
 
 Settlement &Simulation::getSettlement(const string &settlementName) {
-    for (auto &settlement : settlements) {
-        if (settlement->getName() == settlementName) {
-            return *settlement; // Return a reference to the found settlement
-        }
+    Settlement *settlement = findSettlement(settlementName);
+    if (settlement != nullptr) {
+        return *settlement; // Return a reference to the found settlement
     }
 
     throw std::runtime_error("Settlement not found: " + settlementName); // Throw an exception if not found
 }
 
 Plan &Simulation::getPlan(const int planID) {
-    for (auto &plan : plans) {
-        if (plan.getID() == planID) { // Assuming Plan has a getID() method
-            return plan; // Return a reference to the found plan
-        }
+    // Plan IDs are handed out densely from 0, so the ID is the plan's position in the vector
+    if (planID >= 0 && static_cast<size_t>(planID) < plans.size()) {
+        return plans.mutate(planID);
+    }
+
+    throw std::runtime_error("Plan doesn't exist"); // Throw an exception if not found
+}
+
+const Plan &Simulation::getPlan(const int planID) const {
+    if (planID >= 0 && static_cast<size_t>(planID) < plans.size()) {
+        return plans[planID];
     }
 
     throw std::runtime_error("Plan doesn't exist"); // Throw an exception if not found
 }
 
-const vector<BaseAction*> &Simulation::getActionsLog() const {
+Settlement *Simulation::findSettlement(const string &settlementName) const {
+    return findSettlement(settlementName, settlements.size());
+}
+
+Settlement *Simulation::findSettlement(const string &settlementName, size_t count) const {
+    // Entries registered by other copies are skipped. Of our own, the first settlement with the name wins.
+    Settlement *found = nullptr;
+    size_t foundPosition = 0;
+    auto range = settlementIndex->equal_range(settlementName);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        size_t position = entry->second;
+        if (position < count && position < settlements.size() && settlements[position]->getName() == settlementName &&
+            (found == nullptr || position < foundPosition)) {
+            found = settlements[position];
+            foundPosition = position;
+        }
+    }
+    return found;
+}
+
+bool Simulation::isFacilityExists(const string &facilityName) const {
+    auto range = facilityIndex->equal_range(facilityName);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        size_t position = entry->second;
+        if (position < facilitiesOptions->size() && (*facilitiesOptions)[position].getName() == facilityName) {
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<FacilityType> &Simulation::ownFacilitiesOptions() {
+    if (facilitiesOptions.use_count() > 1) {
+        facilitiesOptions = std::make_shared<vector<FacilityType>>(*facilitiesOptions);
+    }
+    return *facilitiesOptions;
+}
+
+void Simulation::resetState() {
+    // Plans first, they refer to the settlements
+    plans.clear();
+    actionsLog.clear();
+    settlements.clear();
+    facilitiesOptions = std::make_shared<vector<FacilityType>>();
+    settlementIndex = std::make_shared<std::unordered_multimap<string, size_t>>();
+    facilityIndex = std::make_shared<std::unordered_multimap<string, size_t>>();
+    arena = std::make_shared<Arena>();
+    planCounter = 0;
+}
+
+const ActionLog &Simulation::getActionsLog() const {
     return actionsLog;
 }
 
+const vector<FacilityType> &Simulation::getFacilitiesOptions() const {
+    return *facilitiesOptions;
+}
+
 
 void Simulation::step() {
-    // Iterate through all plans and execute their step function
-    for (auto &plan : plans) {
-        plan.step();
+    // Every plan is about to change, so take our own copy of any plan still shared with a backup up front
+    plans.makeUnique();
+    const vector<FacilityType> &options = *facilitiesOptions;
+
+    // Serial path: iterate through all plans and execute their step function
+    if (numThreads <= 1 || plans.size() < 2) {
+        for (size_t i = 0; i < plans.size(); i++) {
+            plans.mutate(i).step(options);
+        }
+        return;
+    }
+
+    // Parallel path: every plan only touches its own state and reads its settlement and the shared
+    // facilitiesOptions, so contiguous ranges of plans can be stepped independently.
+    // The result is identical to the serial loop regardless of how the plans are partitioned.
+    getThreadPool().parallelFor(plans.size(), [this, &options](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            plans.mutate(i).step(options);
+        }
+    });
+}
+
+void Simulation::step(int numOfSteps) {
+    // Unshare all plans before the workers write to them, see step()
+    plans.makeUnique();
+
+    if (numThreads <= 1 || plans.size() < 2) {
+        fastForward(0, plans.size(), numOfSteps);
+        return;
+    }
+
+    // Every worker fast-forwards its own range of plans
+    getThreadPool().parallelFor(plans.size(), [this, numOfSteps](size_t begin, size_t end) {
+        fastForward(begin, end, numOfSteps);
+    });
+}
+
+void Simulation::fastForward(size_t begin, size_t end, int numOfSteps) {
+    // Between two events (a refill or a completion) a plan only counts down its construction times,
+    // so each plan is stepped only on its eventful ticks and the quiet ticks in between are skipped in one go.
+    // Plans never interact, so walking each plan's own event timeline to the end, one plan after the other,
+    // ends in the same state as interleaving them tick by tick, while keeping the plan hot in cache.
+    const vector<FacilityType> &options = *facilitiesOptions;
+    for (size_t i = begin; i < end; i++) {
+        Plan &plan = plans.mutate(i);
+        long long synced = 0; // Last tick the plan has been brought up to (long long avoids overflow near INT_MAX)
+        while (true) {
+            long long eventTick = synced + plan.ticksUntilEvent();
+            if (eventTick > numOfSteps) {
+                break;
+            }
+            plan.skip(static_cast<int>(eventTick - 1 - synced));
+            plan.step(options);
+            synced = eventTick;
+        }
+
+        // Count down the remaining quiet ticks
+        plan.skip(static_cast<int>(numOfSteps - synced));
+    }
+}
+
+void Simulation::setNumThreads(int numThreads) {
+    if (numThreads < 1) {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    this->numThreads = numThreads;
+}
+
+int Simulation::getNumThreads() const {
+    return numThreads;
+}
+
+void Simulation::setJournal(Journal *journal) {
+    this->journal = journal;
+}
+
+const Arena &Simulation::getArena() const {
+    return *arena;
+}
+
+void Simulation::saveSnapshot(const string &path, const Simulation *backup) const {
+    SnapshotWriter out;
+    out.writeHeader(backup != nullptr);
+    save(out);
+    if (backup != nullptr) {
+        backup->save(out);
+    }
+    out.saveTo(path);
+}
+
+Simulation Simulation::loadSnapshot(const string &path, Simulation *&backup) {
+    SnapshotReader in(path);
+    bool hasBackup = in.readHeader();
+    Simulation simulation(in);
+    Simulation *loadedBackup = hasBackup ? new Simulation(in) : nullptr;
+    try {
+        in.expectEnd();
+    } catch (...) {
+        delete loadedBackup;
+        throw;
     }
+    backup = loadedBackup;
+    return simulation;
+}
+
+void Simulation::save(SnapshotWriter &out) const {
+    size_t image = out.beginSection();
+    out.writeU8(isRunning ? 1 : 0);
+    out.writeI32(planCounter);
+    out.writeI32(numThreads);
+
+    // Plans refer to their settlement by position
+    std::unordered_map<const Settlement*, uint32_t> settlementPositions;
+    out.writeU32(static_cast<uint32_t>(settlements.size()));
+    for (size_t i = 0; i < settlements.size(); i++) {
+        const Settlement *settlement = settlements[i];
+        settlementPositions.emplace(settlement, static_cast<uint32_t>(i));
+        out.writeString(settlement->getName());
+        out.writeU8(static_cast<uint8_t>(settlement->getType()));
+    }
+
+    out.writeU32(static_cast<uint32_t>(facilitiesOptions->size()));
+    for (const FacilityType &facility : *facilitiesOptions) {
+        out.writeString(facility.getName());
+        out.writeU8(static_cast<uint8_t>(facility.getCategory()));
+        out.writeI32(facility.getCost());
+        out.writeI32(facility.getLifeQualityScore());
+        out.writeI32(facility.getEconomyScore());
+        out.writeI32(facility.getEnvironmentScore());
+    }
+
+    out.writeU32(static_cast<uint32_t>(plans.size()));
+    for (size_t i = 0; i < plans.size(); i++) {
+        out.writeU32(settlementPositions.at(&plans[i].getSettlement()));
+        plans[i].save(out);
+    }
+
+    actionsLog.save(out);
+    out.endSection(image);
+}
+
+ThreadPool &Simulation::getThreadPool() {
+    // (Re)create the pool when the requested thread count changed since it was started
+    if (threadPool == nullptr || threadPool->size() != numThreads) {
+        delete threadPool;
+        threadPool = new ThreadPool(numThreads);
+    }
+    return *threadPool;
 }
 
 void Simulation::close() {
     // Print the summary of all plans
-    for (const auto &plan : plans) {
+    for (size_t i = 0; i < plans.size(); i++) {
+        const Plan &plan = plans[i];
         std::cout << "PlanID: " << plan.getID() << std::endl;
         std::cout << "SettlementName: " << plan.getSettlement().getName() << std::endl; // Assuming Plan provides a way to get Settlement
         std::cout << "LifeQualityScore: " << plan.getlifeQualityScore() << std::endl;
@@ -482,26 +798,9 @@ void Simulation::close() {
     // Mark the simulation as not running
     isRunning = false;
 
-    // Free allocated memory
-    for (BaseAction* action : actionsLog) {
-        delete action;
-    }
-    actionsLog.clear(); // Ensures a clean state before destruction, though not strictly necessary.
-
-    // Free dynamically allocated settlements
-    for (Settlement* settlement : settlements) {
-        delete settlement;
-    }
-    settlements.clear(); // Prevents dangling pointers, though the destructor handles it.
-
-    // Clear plans (no dynamic allocation, just reset the vector)
-    plans.clear(); // Optional but ensures explicit reset of the vector.
-
-    // Clear facilities (no dynamic memory, just reset the vector)
-    facilitiesOptions.clear(); // Keeps the state consistent, though not strictly required.
-
-    // Reset planCounter
-    planCounter = 0;
+    // Start over with an empty state and reset planCounter. Our old state is freed (the logged actions,
+    // and every settlement with the arena's blocks) unless a backup still shares it.
+    resetState();
 
 
     std::cout << "Simulation closed successfully." << std::endl;
@@ -0,0 +1,186 @@
+#include "Snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+const char SNAPSHOT_MAGIC[8] = {'S', 'P', 'L', 'S', 'N', 'A', 'P', '\0'};
+const uint32_t SNAPSHOT_VERSION = 2;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const uint32_t FLAG_HAS_BACKUP = 1;
+}
+
+//-----------SnapshotWriter implementation-----------
+
+SnapshotWriter::SnapshotWriter() : buffer() {}
+
+void SnapshotWriter::writeHeader(bool hasBackup) {
+    writeBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writeU32(SNAPSHOT_VERSION);
+    writeU32(BYTE_ORDER_MARK);
+    writeU32(hasBackup ? FLAG_HAS_BACKUP : 0);
+}
+
+void SnapshotWriter::writeU8(uint8_t value) {
+    writeBytes(&value, sizeof(value));
+}
+
+void SnapshotWriter::writeU32(uint32_t value) {
+    writeBytes(&value, sizeof(value));
+}
+
+void SnapshotWriter::writeI32(int32_t value) {
+    writeBytes(&value, sizeof(value));
+}
+
+void SnapshotWriter::writeString(const string &value) {
+    writeU32(static_cast<uint32_t>(value.size()));
+    writeBytes(value.data(), value.size());
+}
+
+void SnapshotWriter::writeInts(const vector<int> &values) {
+    writeU32(static_cast<uint32_t>(values.size()));
+    writeBytes(values.data(), values.size() * sizeof(int));
+}
+
+size_t SnapshotWriter::beginSection() {
+    size_t section = buffer.size();
+    uint64_t placeholder = 0;
+    writeBytes(&placeholder, sizeof(placeholder));
+    return section;
+}
+
+void SnapshotWriter::endSection(size_t section) {
+    uint64_t length = buffer.size() - section - sizeof(uint64_t);
+    std::memcpy(&buffer[section], &length, sizeof(length));
+}
+
+void SnapshotWriter::saveTo(const string &path) const {
+    // Write next to the target and rename over it, so a failed save never leaves a half-written snapshot behind
+    string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open snapshot file for writing: " + path);
+        }
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.close();
+        if (!file.good()) {
+            std::remove(temporaryPath.c_str());
+            throw std::runtime_error("Failed to write snapshot file: " + path);
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        throw std::runtime_error("Failed to write snapshot file: " + path);
+    }
+}
+
+void SnapshotWriter::writeBytes(const void *data, size_t size) {
+    const char *bytes = static_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+//-----------SnapshotReader implementation-----------
+
+SnapshotReader::SnapshotReader(const string &path)
+    : path(path), file(path), data(file.data()), size(file.size()), position(0) {
+    // An empty file is reported as truncated by the first read
+    if (!file.isOpen()) {
+        throw std::runtime_error("Cannot open snapshot file: " + path);
+    }
+}
+
+bool SnapshotReader::readHeader() {
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    readBytes(magic, sizeof(magic));
+    if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+        corrupt("not a snapshot file");
+    }
+    if (readU32() != SNAPSHOT_VERSION) {
+        corrupt("unsupported snapshot version");
+    }
+    if (readU32() != BYTE_ORDER_MARK) {
+        corrupt("snapshot was written on a machine with a different byte order");
+    }
+    uint32_t flags = readU32();
+    if ((flags & ~FLAG_HAS_BACKUP) != 0) {
+        corrupt("unknown snapshot flags");
+    }
+    return (flags & FLAG_HAS_BACKUP) != 0;
+}
+
+uint8_t SnapshotReader::readU8() {
+    uint8_t value;
+    readBytes(&value, sizeof(value));
+    return value;
+}
+
+uint32_t SnapshotReader::readU32() {
+    uint32_t value;
+    readBytes(&value, sizeof(value));
+    return value;
+}
+
+int32_t SnapshotReader::readI32() {
+    int32_t value;
+    readBytes(&value, sizeof(value));
+    return value;
+}
+
+string SnapshotReader::readString() {
+    uint32_t length = readU32();
+    if (length > size - position) {
+        corrupt("truncated string");
+    }
+    string value(data + position, length);
+    position += length;
+    return value;
+}
+
+vector<int> SnapshotReader::readInts() {
+    uint32_t count = readU32();
+    if (count > (size - position) / sizeof(int)) {
+        corrupt("truncated array");
+    }
+    vector<int> values(count);
+    readBytes(values.data(), count * sizeof(int));
+    return values;
+}
+
+size_t SnapshotReader::beginSection() {
+    uint64_t length;
+    readBytes(&length, sizeof(length));
+    if (length > size - position) {
+        corrupt("truncated section");
+    }
+    return position + static_cast<size_t>(length);
+}
+
+void SnapshotReader::endSection(size_t sectionEnd) {
+    if (position != sectionEnd) {
+        corrupt("section length does not match its content");
+    }
+}
+
+void SnapshotReader::expectEnd() const {
+    if (position != size) {
+        corrupt("trailing data after the last section");
+    }
+}
+
+void SnapshotReader::corrupt(const string &reason) const {
+    throw std::runtime_error("Corrupt snapshot " + path + ": " + reason);
+}
+
+void SnapshotReader::readBytes(void *target, size_t count) {
+    if (count > size - position) {
+        corrupt("unexpected end of file");
+    }
+    // memcpy out of the mapping, values inside it are not necessarily aligned
+    if (count > 0) {
+        std::memcpy(target, data + position, count);
+    }
+    position += count;
+}
@@ -0,0 +1,106 @@
+#include "ThreadPool.h"
+
+//-----------ThreadPool implementation-----------
+
+// Constructor: spawns numThreads-1 workers, the calling thread acts as the last one.
+ThreadPool::ThreadPool(int numThreads)
+    : workers(),
+      mutex(),
+      wakeWorkers(),
+      allDone(),
+      currentTask(nullptr),
+      taskCount(0),
+      pending(0),
+      generation(0),
+      stopping(false),
+      errors(numThreads > 1 ? numThreads : 1) {
+    // Chunk 0 always belongs to the caller, worker i handles chunk i
+    for (int i = 1; i < numThreads; i++) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this, static_cast<size_t>(i)));
+    }
+}
+
+// Destructor: wakes every worker so it can observe `stopping` and joins it.
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)> &task) {
+    // Nothing to split, run inline and skip the synchronization entirely
+    if (workers.empty() || count < 2) {
+        task(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentTask = &task;
+        taskCount = count;
+        pending = workers.size();
+        for (std::exception_ptr &error : errors) {
+            error = nullptr;
+        }
+        generation++;
+    }
+    wakeWorkers.notify_all();
+
+    // The caller processes the first chunk while the workers handle the rest
+    runChunk(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+    currentTask = nullptr;
+
+    for (const std::exception_ptr &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+void ThreadPool::runChunk(size_t chunkIndex) {
+    // Contiguous, evenly sized chunks: chunk i covers [count*i/n, count*(i+1)/n)
+    size_t chunks = errors.size();
+    size_t begin = taskCount * chunkIndex / chunks;
+    size_t end = taskCount * (chunkIndex + 1) / chunks;
+    try {
+        if (begin < end) {
+            (*currentTask)(begin, end);
+        }
+    } catch (...) {
+        errors[chunkIndex] = std::current_exception();
+    }
+}
+
+void ThreadPool::workerLoop(size_t chunkIndex) {
+    unsigned long seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeWorkers.wait(lock, [this, seenGeneration] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runChunk(chunkIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        allDone.notify_one();
+    }
+}
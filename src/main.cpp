@@ -1,18 +1,96 @@
 #include "Simulation.h"
+#include "BatchIO.h"
+#include "Journal.h"
+#include <chrono>
 #include <iostream>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
 Simulation* backup = nullptr;
 
+static void printUsage(){
+    cout << "usage: simulation <config_path> [options]" << endl;
+    cout << "       simulation --snapshot <snapshot_path> [options]" << endl;
+    cout << "options: --threads <num_threads>  --batch <script_path>|-  --journal <journal_path>  --recover <journal_path>" << endl;
+}
+
 int main(int argc, char** argv){
-    if(argc!=2){
-        cout << "usage: simulation <config_path>" << endl;
+    // A snapshot replaces the config file, it takes two arguments instead of one
+    bool fromSnapshot = argc>1 && string(argv[1])=="--snapshot";
+    int first = fromSnapshot ? 3 : 2; // Index of the first optional argument
+    if(argc<first || (argc-first)%2!=0){
+        printUsage();
         return 0;
     }
-    string configurationFile = argv[1];
-    Simulation simulation(configurationFile);
-    simulation.start();
+    string sourceFile = argv[first-1];
+    int numThreads = 0; // 0 means "use the config file value"
+    string batchScript; // Empty for the interactive mode, "-" reads the commands from stdin
+    string journalPath; // Empty when not journaling
+    bool recover = false; // Replay the journal before going on
+    for(int i=first; i<argc; i+=2){
+        string option = argv[i];
+        if(option=="--threads" && atoi(argv[i+1])>=1){
+            numThreads = atoi(argv[i+1]);
+        } else if(option=="--batch"){
+            batchScript = argv[i+1];
+        } else if((option=="--journal" || option=="--recover") && journalPath.empty()){
+            journalPath = argv[i+1];
+            recover = option=="--recover";
+        } else {
+            printUsage();
+            return 0;
+        }
+    }
+    Simulation simulation = fromSnapshot ? Simulation::loadSnapshot(sourceFile, backup) : Simulation(sourceFile, numThreads);
+    if(numThreads>0){
+        simulation.setNumThreads(numThreads); // The command line overrides the config file
+    }
+
+    // Recovery replays the journal onto the config or snapshot, then keeps appending to it
+    size_t keepBytes = 0; // A new journal starts empty
+    if(recover){
+        int fd = open(journalPath.c_str(), O_RDONLY);
+        if(fd<0){
+            cout << "Cannot open journal: " << journalPath << endl;
+            delete backup;
+            return 1;
+        }
+        LineReader journalReader(fd, true);
+        auto begin = chrono::steady_clock::now();
+        size_t commands = simulation.replay(journalReader, keepBytes);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        cerr << "Recovered " << commands << " commands in " << seconds << " s ("
+             << static_cast<long long>(seconds > 0 ? commands / seconds : 0) << " commands/s)" << endl;
+    }
+    Journal *journal = nullptr;
+    if(!journalPath.empty()){
+        journal = new Journal(journalPath, keepBytes);
+        if(!journal->isOpen()){
+            cout << "Cannot open journal: " << journalPath << endl;
+            delete journal;
+            delete backup;
+            return 1;
+        }
+        simulation.setJournal(journal);
+    }
+
+    if(batchScript.empty()){
+        simulation.start();
+    } else {
+        int fd = batchScript=="-" ? STDIN_FILENO : open(batchScript.c_str(), O_RDONLY);
+        if(fd<0){
+            cout << "Cannot open batch script: " << batchScript << endl;
+            delete journal;
+            delete backup;
+            return 1;
+        }
+        LineReader script(fd, fd!=STDIN_FILENO);
+        simulation.startBatch(script);
+    }
+    delete journal; // Commits what is left
     if(backup!=nullptr){
     	delete backup;
     	backup = nullptr;